@@ -14,16 +14,57 @@
  * limitations under the License.
  */
 
+#include <cstdlib>
 #include <iostream>
 
 #include "Compiler.h"
 #include "VM.h"
 
+static int usage() {
+	std::cout << "Usage:" << std::endl;
+	std::cout << "REPL: copper [options]" << std::endl;
+	std::cout << "Run file: copper [options] <file_path>" << std::endl;
+	std::cout << std::endl;
+	std::cout << "Options:" << std::endl;
+	std::cout << "  --gc-max-pause=<us>  Mark and sweep the old space in slices of about <us> microseconds" << std::endl;
+	std::cout << "                       (minor collections, the end of marking and cycles outpaced by" << std::endl;
+	std::cout << "                       allocation may still pause for longer)" << std::endl;
+	std::cout << "  --gc-stats           Print garbage collection statistics on exit" << std::endl;
+	std::cout << "  --no-optimize        Run the bytecode as parsed, without peephole optimizations" << std::endl;
+	return 1;
+}
+
+static bool startsWith(const std::string& str, const std::string& prefix) {
+	return str.compare(0, prefix.size(), prefix) == 0;
+}
+
 int main(int argc, const char* argv[]) {
-	cu::Compiler compiler;
-	cu::VM vm;
+	cu::Heap heap;
+	cu::Compiler compiler(heap);
+	cu::VM vm(heap);
+
+	std::string filepath;
+	bool printGCStats = false;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+
+		if (startsWith(arg, "--gc-max-pause=")) {
+			const auto pause = std::atol(arg.c_str() + arg.find('=') + 1);
+			if (pause <= 0) return usage();
+			heap.setMaxPause(std::chrono::microseconds(pause));
+		} else if (arg == "--gc-stats") {
+			printGCStats = true;
+		} else if (arg == "--no-optimize") {
+			compiler.setOptimize(false);
+		} else if (startsWith(arg, "-") || !filepath.empty()) {
+			return usage();
+		} else {
+			filepath = arg;
+		}
+	}
 
-	if (argc == 1) {
+	if (filepath.empty()) {
 		printf("CopperVM %s (%s %s on %s)\n", COPPER_VERSION, COMPILER_NAME, COMPILER_VERSION, PLATFORM);
 
 		for (;;) {
@@ -33,25 +74,24 @@ int main(int argc, const char* argv[]) {
 
 			if (std::cin.eof()) {
 				std::cout << std::endl;
-				return 0;
+				break;
 			}
 
 			auto translationUnit = cu::TranslationUnit("<stdin>", input);
 			if (compiler.compile(translationUnit))
 				vm.run(compiler.getBytecode(), translationUnit);
 		}
-	} else if (argc == 2) {
-		auto translationUnit = cu::TranslationUnit(argv[1]);
-		if (compiler.compile(translationUnit))
-			return vm.run(compiler.getBytecode(), translationUnit);
-		else
-			return 1;
-	} else {
-		std::cout << "Usage:" << std::endl;
-		std::cout << "REPL: copper" << std::endl;
-		std::cout << "Run file: copper <file_path>" << std::endl;
-		return 1;
+
+		if (printGCStats) heap.printStats(std::cerr);
+		return 0;
 	}
 
-	return 0;
+	auto translationUnit = cu::TranslationUnit(filepath);
+	if (!compiler.compile(translationUnit))
+		return 1;
+
+	const auto status = vm.run(compiler.getBytecode(), translationUnit);
+	if (printGCStats) heap.printStats(std::cerr);
+
+	return status;
 }
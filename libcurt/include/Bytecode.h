@@ -16,13 +16,24 @@
 
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
+#include "InlineCache.h"
 #include "LocationInfo.h"
-#include "Object.h"
+#include "Value.h"
 
 namespace cu {
 
+	/*
+		Every opcode is a single byte. Operands follow the opcode and are a
+		byte each, except for jump distances, which are two bytes. Operands
+		wider than a byte are stored little-endian.
+
+		An operand that does not fit, such as the offset of the 300th
+		constant, is written as four bytes after a WIDE prefix.
+	*/
 	enum OpCode {
 
 		/**
@@ -120,6 +131,28 @@ namespace cu {
 		 */
 		SETVAR,
 
+		/**
+		 * NAME:
+		 * Pop Into Variable
+		 * 
+		 * DESCRIPTION:
+		 * Sets the value of a variable, and pops the value. Emitted by
+		 * the Optimizer in place of SETVAR followed by POP.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The new value must be on the top of the stack.
+		 * - The stack offset of the target variable must be known.
+		 * 
+		 * OPERATION:
+		 * - The value on the top of the stack is assigned to the variable
+		 * at the given stack offset.
+		 * - The value is popped.
+		 * 
+		 * OPERANDS:
+		 * (1) - stack offset to the variable
+		 */
+		POPVAR,
+
 		/**
 		 * NAME:
 		 * Create New Array
@@ -140,6 +173,110 @@ namespace cu {
 		 */
 		NEWARR,
 
+		/**
+		 * NAME:
+		 * Clone Array Template
+		 * 
+		 * DESCRIPTION:
+		 * Creates a new array with the elements of a constant array
+		 * template, used for array literals made only of constants.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The template must be in the constant pool.
+		 * 
+		 * OPERATION:
+		 * - Pushes a new array onto the stack that shares the elements
+		 * of the template until it is first written to.
+		 * 
+		 * OPERANDS:
+		 * (1) - offset of the template in the constant pool
+		 */
+		CLONEARR,
+
+		/**
+		 * NAME:
+		 * Create New Object
+		 * 
+		 * DESCRIPTION:
+		 * Creates a new object with the specified number of properties.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The key and the value of each property must be loaded on the
+		 * stack, in this (LIFO) order.
+		 * 
+		 * OPERATION:
+		 * - Sets the properties on the object, with the bottom-most one
+		 * going in first.
+		 * - Pops the keys and values from the stack.
+		 * 
+		 * OPERANDS:
+		 * (1) - number of properties
+		 */
+		NEWOBJ,
+
+		/**
+		 * NAME:
+		 * Create New Map
+		 * 
+		 * DESCRIPTION:
+		 * Creates a new Map, optionally filled from an array
+		 * of [key, value] entries.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - If there is an argument, the array of entries must be
+		 * loaded onto the stack.
+		 * 
+		 * OPERATION:
+		 * - Pops the array of entries, if any, from the stack.
+		 * - Pushes the new Map onto the stack.
+		 * 
+		 * OPERANDS:
+		 * (1) - number of arguments, either 0 or 1
+		 */
+		NEWMAP,
+
+		/**
+		 * NAME:
+		 * Create New Set
+		 * 
+		 * DESCRIPTION:
+		 * Creates a new Set, optionally filled from an array of values.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - If there is an argument, the array of values must be
+		 * loaded onto the stack.
+		 * 
+		 * OPERATION:
+		 * - Pops the array of values, if any, from the stack.
+		 * - Pushes the new Set onto the stack.
+		 * 
+		 * OPERANDS:
+		 * (1) - number of arguments, either 0 or 1
+		 */
+		NEWSET,
+
+		/**
+		 * NAME:
+		 * Create New Typed Array
+		 * 
+		 * DESCRIPTION:
+		 * Creates a new Float64Array, Int32Array or Uint8Array. Its
+		 * argument is either a length, an array or typed array whose
+		 * elements are copied, or the path of a file to map.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - If there is an argument, it must be loaded onto the stack.
+		 * 
+		 * OPERATION:
+		 * - Pops the argument, if any, from the stack.
+		 * - Pushes the new typed array onto the stack.
+		 * 
+		 * OPERANDS:
+		 * (1) - element type, see TypedArrayObject::ElementType
+		 * (2) - number of arguments, either 0 or 1
+		 */
+		NEWTYPED,
+
 		/**
 		 * NAME:
 		 * Set Object Property
@@ -157,7 +294,7 @@ namespace cu {
 		 * - Sets the target property within the object to the new value.
 		 * 
 		 * OPERANDS:
-		 * None. Required operands are read from the stack.
+		 * (1) - offset of the inline cache of this instruction
 		 */
 		SETPROP,
 
@@ -178,25 +315,47 @@ namespace cu {
 		 * - Else, an attempt to load the property from the object is made.
 		 * 
 		 * OPERANDS:
-		 * None. Required operands are read from the stack.
+		 * (1) - offset of the inline cache of this instruction
 		 */
 		LDPROP,
 
 		/**
 		 * NAME:
-		 * Jump to Offset
+		 * Invoke Method
+		 * 
+		 * DESCRIPTION:
+		 * Calls a built-in method of the receiver.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The receiver and then the arguments must be loaded on the stack.
+		 * - The method name must be defined in the bytecode's constant pool.
+		 * 
+		 * OPERATION:
+		 * - The method is looked up by name for the type of the receiver.
+		 * - Pops the arguments and the receiver from the stack.
+		 * - The value returned by the method is pushed onto the stack.
+		 * 
+		 * OPERANDS:
+		 * (1) - offset of the method name into the bytecode's constant pool
+		 * (2) - number of arguments
+		 */
+		INVOKE,
+
+		/**
+		 * NAME:
+		 * Jump Forward
 		 * 
 		 * DESCRIPTION:
-		 * Jumps to the offset indicated by the operand.
+		 * Jumps forward by the distance indicated by the operand.
 		 * 
 		 * PRE-CONDITIONS:
 		 * None.
 		 * 
 		 * OPERATION:
-		 * - IP is set to the bytecode offset indicated by the operand.
+		 * - IP is advanced by the operand, counting from the next instruction.
 		 * 
 		 * OPERANDS:
-		 * (1) - bytecode offset to jump to
+		 * (1) - two-byte distance to jump forward
 		 */
 		JMP,
 
@@ -205,15 +364,15 @@ namespace cu {
 		 * Jump If Not True
 		 * 
 		 * DESCRIPTION:
-		 * Checks the stack top and if it is truthy, jumps to the offset
-		 * indicated by the operand.
+		 * Checks the stack top and if it is falsy, jumps forward by the
+		 * distance indicated by the operand.
 		 * 
 		 * PRE-CONDITIONS:
 		 * - The stack must have at least one value.
 		 * 
 		 * OPERATION:
 		 * - The value at the top of the stack is checked.
-		 * - If truthy, IP is set to the bytecode offset indicated by the operand.
+		 * - If falsy, IP is advanced by the operand, counting from the next instruction.
 		 * - Truthiness for various Object types is evaluated as follows:
 		 *    - Boolean: The underlying Boolean value is checked.
 		 *    - Number: False if zero, true otherwise.
@@ -221,10 +380,68 @@ namespace cu {
 		 *    - Null and Undefined: Always false.
 		 * 
 		 * OPERANDS:
-		 * (1) - bytecode offset to jump to
+		 * (1) - two-byte distance to jump forward
 		 */
 		JNT,
 
+		/**
+		 * NAME:
+		 * Jump If True
+		 * 
+		 * DESCRIPTION:
+		 * Checks the stack top and if it is true, jumps forward by the
+		 * distance indicated by the operand. Emitted by the Optimizer in
+		 * place of NOT followed by JNT, when the value is popped either way.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The value at the top of the stack must be a boolean, as for NOT.
+		 * 
+		 * OPERATION:
+		 * - The value at the top of the stack is checked, error if non-boolean.
+		 * - If true, IP is advanced by the operand, counting from the next instruction.
+		 * 
+		 * OPERANDS:
+		 * (1) - two-byte distance to jump forward
+		 */
+		JIT,
+
+		/**
+		 * NAME:
+		 * Loop
+		 * 
+		 * DESCRIPTION:
+		 * Jumps backward by the distance indicated by the operand,
+		 * to the start of a loop.
+		 * 
+		 * PRE-CONDITIONS:
+		 * None.
+		 * 
+		 * OPERATION:
+		 * - IP is moved back by the operand, counting from the next instruction.
+		 * 
+		 * OPERANDS:
+		 * (1) - two-byte distance to jump backward
+		 */
+		LOOP,
+
+		/**
+		 * NAME:
+		 * Wide Operand
+		 * 
+		 * DESCRIPTION:
+		 * Prefix that widens the first operand of the next instruction.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - Must be followed by an instruction that takes operands.
+		 * 
+		 * OPERATION:
+		 * - The first operand of the next instruction is read as four bytes.
+		 * 
+		 * OPERANDS:
+		 * None.
+		 */
+		WIDE,
+
 		/**
 		 * ARITHMETIC ADDITION & STRING CONCATENATION
 		 * 
@@ -323,27 +540,145 @@ namespace cu {
 		OR,
 		NOT,
 
+		/**
+		 * INCREMENT & DECREMENT VARIABLE
+		 * 
+		 * DESCRIPTION:
+		 * Increment/Decrement a variable in place.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The variable must hold a number.
+		 * 
+		 * OPERATION:
+		 * - The object type is checked, error if non-numeric.
+		 * - The variable at the operand index is incremented/decremented.
+		 * - The stack is left untouched.
+		 * 
+		 * OPERANDS:
+		 * (1) - stack index of the variable
+		 */
+		INCVAR,
+		DECVAR,
+
+		/**
+		 * REGISTER OPERATIONS
+		 * Applies to ADDR -> NEQR
+		 * 
+		 * DESCRIPTION:
+		 * Same as ADD -> NEQ, but the operands are read from variables
+		 * or constants directly, rather than popped from the stack.
+		 * Thus, i < n is a single instruction instead of three.
+		 * 
+		 * PRE-CONDITIONS:
+		 * - The operands must be defined.
+		 * 
+		 * OPERATION:
+		 * - The two operands are read.
+		 * - The operation is performed as for its stack counterpart.
+		 * - Result is pushed onto the stack.
+		 * 
+		 * OPERANDS:
+		 * (1) - left operand
+		 * (2) - right operand
+		 * 
+		 * An operand below REGISTER_CONSTANT is the stack index of a
+		 * variable. Otherwise, it is REGISTER_CONSTANT plus an offset
+		 * into the bytecode's constant pool.
+		 */
+		ADDR,
+		SUBR,
+		MULR,
+		DIVR,
+		MODR,
+		GRTR,
+		LSTR,
+		GRER,
+		LSER,
+		EQUR,
+		NEQR,
+
 		PRINT,
+
+		/**
+		 * NAME:
+		 * Return
+		 * 
+		 * DESCRIPTION:
+		 * Ends the program. The parser emits it as the last instruction.
+		 * 
+		 * PRE-CONDITIONS:
+		 * None.
+		 * 
+		 * OPERATION:
+		 * - Execution stops.
+		 * 
+		 * OPERANDS:
+		 * None.
+		 */
 		RET
 	};
 
-	typedef size_t byte;
+	typedef uint8_t byte;
+
+	// Register operands from here on name a constant, see ADDR.
+	constexpr byte REGISTER_CONSTANT = 0x80;
 
 	class Bytecode {
 		friend class Disassembler;
+		friend class Optimizer;
 		friend class VM;
 	public:
-		void emit(const byte opcode, const Location& loc);
-		void emit(const byte b1, const byte b2, const Location& loc);
-		size_t addConstant(const Object *);
-		Location getSourceLocation(byte bytecodeOffset) const;
+		void emit(const OpCode, const Location& loc);
+		void emit(const OpCode, const size_t operand, const Location& loc);
+
+		// The second operand always takes a single byte.
+		void emit(const OpCode, const size_t operand, const byte second, const Location& loc);
+
+		// Emits a forward jump with a placeholder distance, and returns
+		// the offset of the distance for patchJump. The jump is wide until
+		// shrinkJumps, as the code it jumps over is yet to be emitted.
+		size_t emitJump(const OpCode, const Location& loc);
+
+		// Points the jump at the end of the bytecode. Returns false
+		// if the distance does not fit in four bytes.
+		bool patchJump(const size_t jumpOffset);
+
+		// Emits a LOOP back to the given offset.
+		void emitLoop(const size_t target, const Location& loc);
+
+		// Narrows the wide jumps whose distance fits in two bytes. The
+		// code after each one moves back, thus only the jumps over it
+		// get shorter and no other has to widen.
+		void shrinkJumps();
+
+		size_t addConstant(const Value&);
+		size_t addPropertyCache();
+		Location getSourceLocation(size_t bytecodeOffset) const;
 		size_t size() const { return blob.size(); }
-		void patch(const size_t offset, const byte b);
 		void clear();
+
+		static uint16_t readShort(const byte* at) {
+			return at[0] | at[1] << 8;
+		}
+
+		static uint32_t readWord(const byte* at) {
+			return at[0] | at[1] << 8 | at[2] << 16 | static_cast<uint32_t>(at[3]) << 24;
+		}
 	private:
 		std::vector<byte> blob;
 		LocationInfo locationInfo;
-		std::vector<std::shared_ptr<Object>> constants;
+		std::vector<Value> constants;
+
+		// Pool offsets by constant, so that repeated literals like true,
+		// 1 or an interned "name" share a single slot.
+		std::unordered_map<uint64_t, size_t> constantOffsets;
+
+		// One per LDPROP and SETPROP instruction. The VM fills
+		// these in as it runs, thus they are mutable.
+		mutable std::vector<PropertyCache> propertyCaches;
+
+		void emitByte(const byte b, const Location& loc);
+		void emitWord(const uint32_t word, const Location& loc);
 	};
 
 } // namespace cu
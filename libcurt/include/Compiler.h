@@ -17,6 +17,7 @@
 #pragma once
 
 #include "Bytecode.h"
+#include "Heap.h"
 #include "Parser.h"
 #include "TranslationUnit.h"
 
@@ -28,9 +29,16 @@ namespace cu {
 	class Compiler {
 	private:
 		Parser parser;
+		Bytecode bytecode;
+		bool optimize = true;
 	public:
+		Compiler(Heap& heap) : parser(heap) {}
+
 		bool compile(TranslationUnit&);
-		Bytecode getBytecode() { return parser.getBytecode(); }
+		const Bytecode& getBytecode() const { return bytecode; }
+
+		// Whether to run the Optimizer over the parsed bytecode.
+		void setOptimize(const bool optimize) { this->optimize = optimize; }
 	};
 
 } // namespace cu
\ No newline at end of file
@@ -26,6 +26,15 @@ namespace cu {
 		void disassemble(const Bytecode&, const TranslationUnit&);
 	private:
 		size_t ip;
+
+		// Offset of the instruction being printed, and whether
+		// its first operand is wide.
+		size_t offset;
+		bool wide = false;
+
+		size_t readOperand(const Bytecode&);
+		size_t readJump(const Bytecode&);
+		void printRegisterInstruction(const std::string& opcode, const Bytecode&);
 		void printInstruction(const std::string& opcode,
 									 const std::string& operands = "",
 							  		 const std::string& comment = "");
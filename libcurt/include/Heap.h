@@ -0,0 +1,316 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Nursery.h"
+#include "Object.h"
+#include "Shape.h"
+#include "SlabAllocator.h"
+#include "StringTable.h"
+
+// #define DEBUG_STRESS_GC
+// #define DEBUG_LOG_GC
+
+namespace cu {
+
+	struct GCStats {
+		size_t minorCollections = 0;
+		size_t majorCollections = 0;
+		size_t slices = 0;
+		std::chrono::nanoseconds maxPause{0};
+		std::chrono::nanoseconds totalPause{0};
+	};
+
+	/*
+		Owner of every heap-allocated Object (strings and arrays).
+
+		Values only hold raw pointers into the Heap, so the Heap has to
+		outlive every Bytecode and VM that refer to its objects. It is
+		shared between the Compiler, which allocates constants, and the
+		VM, which allocates at runtime.
+
+		The Heap is split into two generations:
+
+		- Young objects are bump-allocated in the Nursery. A minor
+		  collection copies the survivors into the old space and then
+		  empties the nursery in one go.
+		- Old objects are allocated from the size-class slabs of a
+		  SlabAllocator and reclaimed by a tracing mark-and-sweep collector.
+
+		By default, old space collections stop the world. In incremental
+		mode, marking and sweeping are instead split into slices that each
+		run for about the configured pause, and the program keeps running
+		in between. Large objects are traced a step at a time, so a slice
+		can end in the middle of one. The pause bound does not cover:
+
+		- minor collections, whose pauses grow with how much of the
+		  nursery survives, up to its whole size
+		- the final marking pause, which promotes the nursery, rescans
+		  the roots and prunes the string and transition tables
+		- cycles that fall behind the program's allocation, whose
+		  remaining work is done in a single pause
+
+		Objects are colored as follows while marking:
+
+		- white: not marked, possibly garbage
+		- gray: marked and still in the gray stack
+		- black: marked and traced
+
+		Every store of a Value into an object must go through writeBarrier().
+		It remembers old objects that are made to point to young ones, so
+		that minor collections can treat them as roots, and it shades the
+		stored object gray while marking, so that black objects never point
+		to white ones. Stores into the elements of an array pass their
+		indices, so that only the written cards of a large array are
+		rescanned rather than the whole of it.
+
+		The Heap never starts a collection by itself since it cannot see
+		the roots. Instead, the VM checks shouldCollect() at its safepoints
+		and calls collect() with a function that visits its roots.
+	*/
+	class Heap {
+	public:
+		Heap();
+		Heap(const Heap&) = delete;
+		Heap& operator=(const Heap&) = delete;
+		~Heap();
+
+		template <typename T, typename... Args>
+		T* allocate(Args&&... args) {
+			allocationsSinceSlice++;
+
+			void* memory = nursery.allocate(sizeof(T));
+			if (memory != nullptr) {
+				return new (memory) T(std::forward<Args>(args)...);
+			}
+
+			// The nursery stays exhausted until the next safepoint.
+			return allocateTenured<T>(std::forward<Args>(args)...);
+		}
+
+		/*
+			Allocates straight into the old space. This is required for
+			objects whose references the collector cannot update, such as
+			the constants of a Bytecode.
+		*/
+		template <typename T, typename... Args>
+		T* allocateTenured(Args&&... args) {
+			static_assert(sizeof(T) <= UINT16_MAX, "Object too large for its cell size");
+
+			T* obj = new (slabs.allocate(sizeof(T))) T(std::forward<Args>(args)...);
+			obj->cellSize = sizeof(T);
+			track(obj);
+			return obj;
+		}
+
+		/*
+			Returns the unique string with the given contents, allocating
+			it if needed. Interned strings are tenured so that their address
+			never changes, and they stay in the table only for as long as
+			something else refers to them.
+		*/
+		StringObject* intern(const std::string& utf8);
+		StringObject* intern(const StringObject&);
+
+		// Like intern(), but returns nullptr instead of allocating.
+		StringObject* findInterned(const std::string& utf8) const;
+		StringObject* findInterned(const StringObject&) const;
+
+		// Shape of a new object, before any key is added to it.
+		Shape* emptyShape() { return rootShape; }
+
+		/*
+			Returns the shape of an object of the given shape once the key
+			is added to it, which must not already be present. The edge is
+			kept only for as long as the returned shape is alive.
+		*/
+		Shape* addProperty(Shape*, StringObject* key);
+
+		void writeBarrier(Object* holder, const Value& value) {
+			if (!value.isObject()) return;
+
+			Object* obj = value.asObject();
+			if (nursery.contains(obj)) {
+				if (!holder->remembered && !nursery.contains(holder)) remember(holder);
+			} else if (phase == Phase::MARKING && holder->marked && !obj->marked) {
+				markObject(obj);
+			}
+		}
+
+		// Stores of the value into the elements [start, end) of the array.
+		void writeBarrier(ArrayObject* holder, const size_t start, const size_t end, const Value& value) {
+			if (!value.isObject()) return;
+
+			Object* obj = value.asObject();
+			if (nursery.contains(obj)) {
+				if (nursery.contains(holder)) return;
+
+				holder->markCards(start, end);
+				if (!holder->remembered) remember(holder);
+			} else if (phase == Phase::MARKING && holder->marked && !obj->marked) {
+				markObject(obj);
+			}
+		}
+
+		void writeBarrier(ArrayObject* holder, const size_t index, const Value& value) {
+			writeBarrier(holder, index, index + 1, value);
+		}
+
+		/*
+			Stores into roots need no generational barrier since the roots
+			are scanned on every collection. While marking, the stored object
+			is still shaded so that less work is left for the final pause.
+		*/
+		void writeBarrier(const Value& value) {
+			if (phase == Phase::MARKING && value.isObject()) {
+				Object* obj = value.asObject();
+				if (!obj->marked && !nursery.contains(obj)) markObject(obj);
+			}
+		}
+
+		bool shouldCollect() const {
+#ifdef DEBUG_STRESS_GC
+			return true;
+#else
+			if (phase != Phase::IDLE && allocationsSinceSlice >= SLICE_INTERVAL) return true;
+			return nursery.isExhausted() || bytesAllocated > nextGC;
+#endif
+		}
+
+		typedef std::function<void(Tracer&)> RootTracer;
+		void collect(const RootTracer&);
+
+		// Switches old space collections to incremental slices of about
+		// the given duration. See above for the pauses it does not bound.
+		void setMaxPause(const std::chrono::microseconds);
+
+		const GCStats& getStats() const { return stats; }
+		void printStats(std::ostream&) const;
+	private:
+		class Marker;
+		class Scavenger;
+
+		enum class Phase {
+			IDLE,
+			MARKING,
+			SWEEPING,
+		};
+
+		Nursery nursery;
+		std::vector<Object*> rememberedSet;
+		std::vector<Object*> promotedStack;
+
+		// Old space
+		SlabAllocator slabs;
+		Object* objects = nullptr;
+		StringTable strings;
+		std::vector<Object*> grayStack;
+
+		// Gray object whose tracing was cut short by the end of a
+		// slice, and where to resume it.
+		Object* tracing = nullptr;
+		TraceCursor cursor;
+
+		// Root of the shape tree, which is never freed.
+		Shape* rootShape;
+
+		struct Transition {
+			const Shape* shape;
+			const StringObject* key;
+
+			bool operator==(const Transition& other) const {
+				return shape == other.shape && key == other.key;
+			}
+		};
+
+		struct TransitionHash {
+			size_t operator()(const Transition& transition) const {
+				const std::hash<const void*> hash;
+				return hash(transition.shape) * 31 + hash(transition.key);
+			}
+		};
+
+		// Edges of the shape tree. Like the string table, this does not
+		// keep its shapes alive, and loses those that are swept.
+		std::unordered_map<Transition, Shape*, TransitionHash> transitions;
+
+		// Sliced strings traced in the current cycle.
+		std::vector<StringObject*> slicedStrings;
+
+		// Objects left to sweep in the current cycle.
+		Object* unswept = nullptr;
+
+		Phase phase = Phase::IDLE;
+		bool incremental = false;
+		std::chrono::microseconds maxPause{0};
+		size_t allocationsSinceSlice = 0;
+
+		/*
+			Bytes allocated in the old space since the last collection plus
+			the bytes that survived it. Objects that grow after being
+			allocated (arrays) are only accounted for once they have
+			survived a collection.
+		*/
+		size_t bytesAllocated = 0;
+		size_t nextGC = INITIAL_GC_THRESHOLD;
+
+		GCStats stats;
+
+		static constexpr size_t NURSERY_SIZE = 256 * 1024;
+		static constexpr size_t INITIAL_GC_THRESHOLD = 1024 * 1024;
+		static constexpr size_t GC_GROWTH_FACTOR = 2;
+
+		// Number of allocations between two incremental slices.
+		static constexpr size_t SLICE_INTERVAL = 1024;
+
+		// Number of objects processed between two clock checks.
+		static constexpr size_t SLICE_CHECK_INTERVAL = 128;
+
+		// Number of Values of a large object traced between two clock checks.
+		static constexpr size_t TRACE_STEP = 1024;
+
+		// Sliced strings shorter than 1 / SLICED_STRING_RATIO of an
+		// otherwise dead parent are copied out of it.
+		static constexpr size_t SLICED_STRING_RATIO = 4;
+
+		void track(Object*);
+		void free(Object*);
+		void remember(Object*);
+
+		void scavenge(const RootTracer&);
+		Object* promote(Object*);
+
+		void startMarking(const RootTracer&);
+		bool markSlice(const std::chrono::steady_clock::time_point deadline);
+		void finishMarking(const RootTracer&);
+		void releaseSliceParents();
+		void markObject(Object*);
+
+		void startSweeping();
+		bool sweepSlice(const std::chrono::steady_clock::time_point deadline);
+		void finishCycle();
+	};
+
+} // namespace cu
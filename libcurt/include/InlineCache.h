@@ -0,0 +1,95 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Shape.h"
+
+namespace cu {
+
+	/*
+		Remembers where the properties accessed by one LDPROP or SETPROP
+		instruction were found, so that the next access to an object of
+		the same shape can go straight to the slot.
+
+		A site starts out monomorphic, seeing a single shape, and can
+		record up to MAX_ENTRIES of them. A site that sees more shapes
+		than that is megamorphic and is no longer cached.
+
+		An entry with a transition is only used by SETPROP. It records
+		that setting the key on an object of the shape adds a slot and
+		moves the object to the transition shape.
+	*/
+	class PropertyCache {
+	public:
+		struct Entry {
+			const Shape* shape;
+			const StringObject* key;
+			size_t slot;
+			Shape* transition;
+		};
+
+		// Returns the entry for the shape and property, or nullptr.
+		const Entry* find(const Shape* shape, const Value& property) const {
+			if (shape == nullptr || !property.isObject()) return nullptr;
+
+			const Object* key = property.asObject();
+			for (uint8_t i = 0; i < count; i++) {
+				if (entries[i].shape == shape && entries[i].key == key) return &entries[i];
+			}
+
+			return nullptr;
+		}
+
+		void add(const Entry& entry) {
+			if (megamorphic) return;
+
+			if (count == MAX_ENTRIES) {
+				megamorphic = true;
+				count = 0;
+				return;
+			}
+
+			entries[count++] = entry;
+		}
+
+		bool isMegamorphic() const { return megamorphic; }
+
+		// Visits the shapes of the entries, which the cache keeps alive.
+		// Shapes are tenured and never move, so visiting copies is enough.
+		void trace(Tracer& tracer) const {
+			for (uint8_t i = 0; i < count; i++) {
+				Value shape = Value::object(entries[i].shape);
+				tracer.visit(shape);
+
+				if (entries[i].transition != nullptr) {
+					Value transition = Value::object(entries[i].transition);
+					tracer.visit(transition);
+				}
+			}
+		}
+	private:
+		static constexpr uint8_t MAX_ENTRIES = 4;
+
+		std::array<Entry, MAX_ENTRIES> entries;
+		uint8_t count = 0;
+		bool megamorphic = false;
+	};
+
+} // namespace cu
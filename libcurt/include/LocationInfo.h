@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
 
 namespace cu {
 
@@ -74,6 +75,21 @@ namespace cu {
 			return { 0, 0 };
 		}
 
+		// The location of every byte, in the order that get counts them.
+		std::vector<Location> expand() const {
+			std::vector<Location> locations;
+
+			for (const auto& lineItr : lines) {
+				for (const auto& colItr : lineItr.second.cols) {
+					for (unsigned int i = 0; i < colItr.second; i++) {
+						locations.push_back({ lineItr.first, colItr.first });
+					}
+				}
+			}
+
+			return locations;
+		}
+
 		void clear() {
 			lines.clear();
 		}
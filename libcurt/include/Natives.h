@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "Heap.h"
+
+namespace cu {
+
+	struct NativeCall {
+		Heap& heap;
+		const Value& receiver;
+		const Value* args;
+		size_t argCount;
+
+		// Missing arguments are undefined, as in JavaScript.
+		Value arg(const size_t index) const {
+			return index < argCount ? args[index] : Value::undefined();
+		}
+	};
+
+	/*
+		Built-in methods, called by INVOKE.
+
+		A method either stores its return value in result and returns true,
+		or returns false with a message in error. Methods may allocate, but
+		the arguments stay on the VM's stack, and thus alive, until the
+		method returns.
+	*/
+	typedef bool (*NativeMethod)(const NativeCall&, Value& result, std::string& error);
+
+	// Returns nullptr if the receiver has no method with that name.
+	NativeMethod findMethod(const Value& receiver, const StringObject& name);
+
+	// Reads the length or a character of a string.
+	Value stringProperty(Heap&, const Value& str, const Value& property);
+
+	// Reads the size of a Map or Set.
+	Value collectionProperty(const Value& collection, const Value& property);
+
+	/*
+		Fill a new Map from an array of [key, value] arrays, or a new Set
+		from an array of values, as for new Map(entries) and new Set(values).
+	*/
+	bool fillMap(Heap&, MapObject&, const Value& entries, std::string& error);
+	bool fillSet(Heap&, SetObject&, const Value& values, std::string& error);
+
+	/*
+		Creates a typed array, as for new Float64Array(source). The source
+		is a length, an array or typed array to copy, or the path of a file
+		to map. A missing source is a length of 0.
+	*/
+	bool newTypedArray(Heap&, const TypedArrayObject::ElementType, const Value& source,
+		Value& result, std::string& error);
+
+} // namespace cu
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cu {
+
+	/*
+		Loops over contiguous doubles, for the builtins of packed arrays
+		and Float64Arrays. With SSE2, each iteration handles four elements
+		in two vectors. Elsewhere, they are plain loops.
+
+		The data need not be aligned. The elements of a packed array are
+		Values, whose bits are those of the number they hold, so they can
+		be scanned in place.
+	*/
+	class NumberKernels {
+	public:
+		static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+		/*
+			Index of the first element in [from, size) that is === to the
+			number, which excludes NaN. Every Value that is not a number
+			is a NaN bit pattern, so this also works on arrays of Values
+			that are not all numbers.
+		*/
+		static size_t find(const double* data, const size_t size, const size_t from, const double number);
+
+		// Index of the first NaN in [from, size).
+		static size_t findNaN(const double* data, const size_t size, const size_t from);
+
+		/*
+			The lanes are summed separately and then added together, so
+			the result may be rounded differently than by a left-to-right
+			loop.
+		*/
+		static double sum(const double* data, const size_t size);
+
+		/*
+			Like Math.min() and Math.max(): NaN if any element is NaN, and
+			-0 is less than 0. An empty range gives Infinity for min() and
+			-Infinity for max().
+		*/
+		static double min(const double* data, const size_t size);
+		static double max(const double* data, const size_t size);
+	};
+
+} // namespace cu
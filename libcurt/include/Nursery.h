@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "Object.h"
+
+namespace cu {
+
+	/*
+		The young generation of the Heap.
+
+		Objects are allocated by bumping a pointer through a fixed-size
+		buffer. Each object is preceded by a Cell header which records its
+		size, so that the nursery can be walked linearly, and where it was
+		promoted to once it survives a minor collection.
+
+		  [Cell][Object ...][Cell][Object ...]      ...      |
+		  ^start                                   ^top      ^end
+	*/
+	class Nursery {
+	public:
+		struct alignas(16) Cell {
+			// Exact size of the object following this header.
+			size_t size;
+
+			// Copy of the object in old space, once it has been promoted.
+			Object* forwarded;
+		};
+
+		Nursery(const size_t capacity)
+			: buffer(new Cell[capacity / sizeof(Cell)]),
+			  start(reinterpret_cast<char*>(buffer.get())),
+			  end(start + capacity / sizeof(Cell) * sizeof(Cell)),
+			  top(start) {}
+
+		Nursery(const Nursery&) = delete;
+		Nursery& operator=(const Nursery&) = delete;
+		~Nursery() { reset(); }
+
+		// Returns nullptr once the nursery is exhausted.
+		void* allocate(const size_t size) {
+			const size_t cellSize = sizeof(Cell) + align(size);
+			if (cellSize > size_t(end - top)) {
+				exhausted = true;
+				return nullptr;
+			}
+
+			Cell* cell = reinterpret_cast<Cell*>(top);
+			cell->size = size;
+			cell->forwarded = nullptr;
+
+			top += cellSize;
+			return cell + 1;
+		}
+
+		bool contains(const Object* obj) const {
+			const char* address = reinterpret_cast<const char*>(obj);
+			return address >= start && address < top;
+		}
+
+		bool isEmpty() const { return top == start; }
+		bool isExhausted() const { return exhausted; }
+		size_t used() const { return top - start; }
+
+		static Cell* cellOf(const Object* obj) {
+			return reinterpret_cast<Cell*>(const_cast<Object*>(obj)) - 1;
+		}
+
+		// Destroys every object that was not promoted and
+		// makes the whole buffer available again.
+		void reset() {
+			char* cursor = start;
+			while (cursor < top) {
+				Cell* cell = reinterpret_cast<Cell*>(cursor);
+				if (cell->forwarded == nullptr) {
+					reinterpret_cast<Object*>(cell + 1)->~Object();
+				}
+
+				cursor += sizeof(Cell) + align(cell->size);
+			}
+
+			top = start;
+			exhausted = false;
+		}
+	private:
+		std::unique_ptr<Cell[]> buffer;
+		char* const start;
+		char* const end;
+		char* top;
+		bool exhausted = false;
+
+		static size_t align(const size_t size) {
+			return (size + sizeof(Cell) - 1) & ~(sizeof(Cell) - 1);
+		}
+	};
+
+} // namespace cu
@@ -18,98 +18,777 @@
 
 #include <iostream>
 #include <cmath>
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <new>
+#include <unordered_map>
 #include <string>
 #include <vector>
 
+#include "PropertyDictionary.h"
+#include "RawBuffer.h"
+#include "Value.h"
+#include "ValueTable.h"
+
 namespace cu {
 
-    enum class ObjectType {
-		BOOLEAN,
-		NUMBER,
-		STRING,
-		ARRAY,
-		UNDEFINED,
-		NULL_TYPE,
+	class Heap;
+	class StringObject;
+
+	/*
+		Where an incremental trace of an object left off, see
+		Object::traceSome(). What part and index count is up to the
+		object. Objects whose Values may be reordered also record their
+		layout, and start over if it has changed since.
+	*/
+	struct TraceCursor {
+		size_t part = 0;
+		size_t index = 0;
+		size_t layout = 0;
+	};
+
+	/*
+		Visits the Value slots of an object, see Object::trace().
+		Tracers may overwrite the slot, which is how the Heap
+		updates references to objects that it has moved.
+	*/
+	class Tracer {
+	public:
+		virtual void visit(Value&) = 0;
+
+		/*
+			Visits the parent of a sliced string. Collectors that may copy
+			the slice out instead of keeping its parent alive override this.
+		*/
+		virtual void visitSliceParent(StringObject&);
 	};
 
 	class Object {
 	public:
 		Object(ObjectType type) : type(type) {}
+		virtual ~Object() = default;
 		
 		virtual std::string toString() const = 0;
 		friend std::ostream &operator<<(std::ostream&, const Object&);
 
+		// Visits every Value held by this object.
+		virtual void trace(Tracer&) {}
+
+		/*
+			Visits the Values that may have been made to point into the
+			nursery since the object was remembered by the Heap. Objects
+			that record which of their slots were written override this.
+		*/
+		virtual void traceRemembered(Tracer& tracer) { trace(tracer); }
+
+		/*
+			Visits about limit of the Values held by this object, resuming
+			from the cursor, and returns whether all of them have been
+			visited. This lets the Heap split the marking of objects that
+			hold many Values across slices. Those override it; the others
+			visit everything at once.
+		*/
+		virtual bool traceSome(Tracer& tracer, TraceCursor&, const size_t) {
+			trace(tracer);
+			return true;
+		}
+
+		// Approximate number of bytes owned by this object,
+		// used by the Heap to decide when to collect.
+		virtual size_t footprint() const = 0;
+
+		// Move-constructs this object into the given memory. Used
+		// by the Heap to promote objects out of the nursery.
+		virtual Object* relocate(void* memory) = 0;
+
 		const ObjectType type;
+	private:
+		friend class Heap;
+
+		bool marked = false;
+
+		// Set while the object is in the Heap's remembered set.
+		bool remembered = false;
+
+		// Size of the object's old-space cell, needed to free it.
+		// Declared here so that it fits in the padding after type.
+		uint16_t cellSize = 0;
+
+		// Intrusive list of every object in the Heap's old space.
+		Object* next = nullptr;
+	};
+
+	// Non-owning view of the code units of a string.
+	struct StringUnits {
+		const char* data;
+		size_t size;
+
+		bool operator==(const StringUnits& other) const {
+			return size == other.size && std::memcmp(data, other.data, size) == 0;
+		}
+
+		std::string str() const { return std::string(data, size); }
 	};
 
-	class EmptyObject : public Object {
+	/*
+		A string takes one of three forms:
+
+		- flat: it holds its characters in a std::string.
+		- rope: the concatenation of two other strings. Concatenating only
+		  creates a rope node, so building a string piece by piece is linear
+		  instead of quadratic. The characters of a rope are only gathered
+		  the first time they are needed, at which point the rope becomes
+		  flat and lets go of its halves.
+		- slice: a range of the characters of a flat parent string, which
+		  it shares instead of copying. The Heap copies a slice out of its
+		  parent when it would be the only thing keeping a much larger
+		  parent alive, see Heap::releaseSliceParents().
+
+		Strings are sequences of UTF-16 code units, as in JavaScript. When
+		every unit fits in a byte (Latin-1, which includes ASCII), they are
+		stored one byte each. Otherwise, they take two bytes each, in the
+		native byte order. This form is canonical: a two-byte string always
+		has a unit above 0xFF, so strings of different widths never have
+		the same contents.
+	*/
+	class StringObject : public Object {
 	public:
-		EmptyObject(const ObjectType& type)
-			: Object(type) {}
+		// Decodes UTF-8, such as a lexeme or the output of toString().
+		StringObject(const std::string& utf8)
+			: Object(ObjectType::STRING), twoByte(encode(utf8, val)), len(val.length() >> twoByte) {}
 
+		// Takes code units that are already in canonical form, see encode().
+		StringObject(std::string&& units, const bool twoByte)
+			: Object(ObjectType::STRING), val(std::move(units)), twoByte(twoByte), len(val.length() >> twoByte) {}
+
+		// Both halves must be strings.
+		StringObject(const Value& first, const Value& second)
+			: Object(ObjectType::STRING), first(first), second(second), form(Form::ROPE),
+			  twoByte(first.asString()->twoByte || second.asString()->twoByte),
+			  len(first.asString()->length() + second.asString()->length()) {}
+
+		/*
+			Slices [start, start + length) of a flat parent. The range must
+			be in canonical form on its own, see slice() which takes care
+			of this.
+		*/
+		StringObject(const Value& parent, const uint32_t start, const size_t length)
+			: Object(ObjectType::STRING), first(parent), form(Form::SLICE),
+			  twoByte(parent.asString()->twoByte), offset(start), len(length) {}
+
+		// Encodes the string as UTF-8.
 		std::string toString() const;
+
+		void trace(Tracer&);
+		size_t footprint() const { return sizeof(StringObject) + val.capacity(); }
+		Object* relocate(void* memory) { return new (memory) StringObject(std::move(*this)); }
+
+		// The code units of the string, one or two bytes each.
+		StringUnits units() const {
+			if (form == Form::ROPE) flatten();
+
+			if (form == Form::SLICE) {
+				const auto& parent = first.asString()->val;
+				return StringUnits{ parent.data() + (size_t(offset) << twoByte), len << twoByte };
+			}
+
+			return StringUnits{ val.data(), val.size() };
+		}
+
+		char16_t unitAt(const size_t index) const;
+
+		size_t length() const { return len; }
+		bool isTwoByte() const { return twoByte; }
+		bool isRope() const { return form == Form::ROPE; }
+		bool isSlice() const { return form == Form::SLICE; }
+
+		// Gathers the characters of a rope into this string.
+		void flatten() const;
+
+		/*
+			Returns the units in [start, end) of the string, as a new string
+			or as the string itself if that is the whole range. Short ranges
+			are copied, longer ones share the characters of this string.
+		*/
+		static Value slice(Heap&, const Value& str, const size_t start, const size_t end);
+
+		// Strings are immutable, so their hash is computed once.
+		uint64_t hashCode() const {
+			if (!hashed) {
+				hash = hashOf(units());
+				hashed = true;
+			}
+
+			return hash;
+		}
+
+		bool equals(const StringObject& other) const {
+			return len == other.len && twoByte == other.twoByte &&
+				hashCode() == other.hashCode() && units() == other.units();
+		}
+
+		/*
+			Converts UTF-8 to the canonical code units of a string and
+			returns whether they are two bytes wide. Malformed sequences
+			are replaced by U+FFFD.
+		*/
+		static bool encode(const std::string& utf8, std::string& units);
+		static uint64_t hashOf(const StringUnits& units);
+
+		// Interned strings are unique per contents, see Heap::intern().
+		bool isInterned() const { return interning != Interning::NONE; }
+
+		/*
+			Whether an interned string is the canonical form of an array
+			index, such as "0" or "42" but not "042" or "4.0". This is
+			decided once, when the string is interned.
+		*/
+		bool isArrayIndex() const { return interning == Interning::INDEX; }
+		uint32_t arrayIndex() const { return index; }
+
+		// Decides whether the units are the canonical form of an array index.
+		static bool parseArrayIndex(const StringUnits& units, const bool twoByte, uint32_t& index);
+
+		// Concatenations shorter than this are copied into a flat string,
+		// which is cheaper than a rope for both memory and later reads.
+		static constexpr size_t MIN_ROPE_LENGTH = 13;
+
+		// Slices shorter than this are copied out of their parent.
+		static constexpr size_t MIN_SLICE_LENGTH = 13;
+	private:
+		friend class Heap;
+		friend class Tracer;
+
+		enum class Form : uint8_t {
+			FLAT,
+			ROPE,
+			SLICE,
+		};
+
+		enum class Interning : uint8_t {
+			NONE,
+			NAME,
+			INDEX,
+		};
+
+		mutable std::string val;
+
+		// Halves of a rope, undefined once it has been flattened.
+		// The first one is the parent of a slice.
+		mutable Value first, second;
+
+		mutable Form form = Form::FLAT;
+		bool twoByte;
+		mutable bool hashed = false;
+		Interning interning = Interning::NONE;
+
+		// Interned strings are flat, so they never need an offset.
+		union {
+			// Start of a slice in its parent, in code units.
+			uint32_t offset = 0;
+
+			// Value of an interned array index.
+			uint32_t index;
+		};
+
+		size_t len;
+		mutable uint64_t hash = 0;
+
+		// Turns a slice into a flat string with its own copy of the units.
+		void copyOut();
+
+		// Called by the Heap once the string is in its string table.
+		void markInterned();
 	};
 
-	class BooleanObject : public Object {
+	/*
+		Elements of an array are kept in one of two modes.
+
+		Dense arrays store every element up to their length in a vector,
+		with holes filled by undefined. A write that would leave a large
+		hole switches the array to sparse mode instead, where only the
+		elements that were written are kept, in a hash table. Once a sparse
+		array fills up again it goes back to dense mode.
+
+		A dense array also tracks the kind of its elements. While every
+		element is a number, the vector is effectively a packed array of
+		doubles: it holds no pointers to trace, and the VM reads and writes
+		it through getPacked() and setPacked() without any of the checks
+		that get() and set() need. The first store of anything else, or of
+		a hole, makes the array generic for good.
+
+		Array literals made only of constants are compiled to a template
+		array in the constant pool. Arrays created from a template share
+		its elements, and only copy them the first time they are written.
+
+		Stores into elements go through the Heap's element write barrier,
+		which records the cards, runs of CARD_SIZE elements, that were
+		written. Minor collections then only rescan those cards, whatever
+		the length of the array.
+	*/
+	class ArrayObject : public Object {
 	public:
-		BooleanObject(const std::string& lexeme)
-			: Object(ObjectType::BOOLEAN), val(lexeme == "true") {}
+		ArrayObject()
+			: Object(ObjectType::ARRAY) {}
 
-		BooleanObject(const bool& val)
-			: Object(ObjectType::BOOLEAN), val(val) {}
+		// Shares the elements of a tenured template, which must be dense.
+		explicit ArrayObject(const ArrayObject* source)
+			: Object(ObjectType::ARRAY), kind(source->kind), shared(source) {}
 
 		std::string toString() const;
-		bool get() const { return val; }
+		void trace(Tracer&);
+		void traceRemembered(Tracer&);
+		bool traceSome(Tracer&, TraceCursor&, const size_t limit);
+		size_t footprint() const;
+		Object* relocate(void* memory) { return new (memory) ArrayObject(std::move(*this)); }
+
+		void push(const Value& value);
+		size_t length() const { return sparse ? sparse->length : dense().size(); }
+		bool isSparse() const { return sparse != nullptr; }
+
+		// Removes the last element and returns it, or undefined if the array is empty.
+		Value pop();
+
+		// Stores the value at every index in [start, end), which must not be past the end.
+		void fill(const Value& value, const size_t start, const size_t end);
+
+		// Whether every element is a number, in which case elements() holds doubles.
+		bool isPacked() const { return kind == ElementKind::PACKED_DOUBLE; }
+
+		// Indices of the elements of a sparse array, in increasing order.
+		std::vector<uint32_t> sparseIndices() const;
+
+		const Value operator[] (const size_t index) const;
+
+		// The elements of a dense array, without copying them.
+		struct ElementView {
+			const Value* data;
+			size_t size;
+
+			const Value* begin() const { return data; }
+			const Value* end() const { return data + size; }
+			const Value& operator[] (const size_t index) const { return data[index]; }
+		};
+
+		// Sparse arrays have no contiguous elements, and an empty view.
+		ElementView elements() const {
+			if (sparse) return ElementView{ nullptr, 0 };
+
+			const auto& elements = dense();
+			return ElementView{ elements.data(), elements.size() };
+		}
+
+		/*
+			Fast paths for packed double arrays. These return false, without
+			doing anything, unless the array is packed, the property is an
+			index in range and, for setPacked(), the value is a number.
+			Writing just past the end appends to the array.
+		*/
+		bool getPacked(const Value& property, Value& result) const {
+			if (kind != ElementKind::PACKED_DOUBLE || !property.isNumber()) return false;
+
+			const auto& elements = dense();
+			const double number = property.asNumber();
+			if (!(number >= 0 && number < elements.size())) return false;
+
+			const auto index = static_cast<size_t>(number);
+			if (index != number) return false;
+
+			result = elements[index];
+			return true;
+		}
+
+		bool setPacked(const Value& property, const Value& value) {
+			if (kind != ElementKind::PACKED_DOUBLE || !property.isNumber() || !value.isNumber()) return false;
+
+			const double number = property.asNumber();
+			if (!(number >= 0 && number <= length())) return false;
+
+			const auto index = static_cast<size_t>(number);
+			if (index != number) return false;
+
+			unshare();
+			if (index == val.size()) {
+				val.push_back(value);
+			} else {
+				val[index] = value;
+			}
+
+			return true;
+		}
+
+		/*
+			Named properties are keyed by interned strings, so
+			looking one up only hashes and compares a pointer.
+			These go through the Heap to intern the key and to
+			apply the write barrier. The length is read-only.
+		*/
+		const Value get(const Value& property, const Heap&) const;
+		void set(const Value& property, const Value& value, Heap&);
+
+		static constexpr size_t CARD_SIZE = 128;
 	private:
-		bool val;
+		friend class Heap;
+
+		struct SparseElements {
+			std::unordered_map<uint32_t, Value> elements;
+			size_t length;
+		};
+
+		enum class ElementKind : uint8_t {
+			PACKED_DOUBLE,
+			GENERIC
+		};
+
+		std::vector<Value> val;
+		std::unique_ptr<SparseElements> sparse;
+		ElementKind kind = ElementKind::PACKED_DOUBLE;
+		PropertyDictionary props;
+
+		// Bumped whenever elements may have moved, see traceSome().
+		uint32_t layout = 0;
+
+		// Template whose elements this array uses instead of val, if any.
+		const ArrayObject* shared = nullptr;
+
+		// Cards written since the last minor collection, possibly with
+		// duplicates. Compacted once it doubles past cardsCompacted.
+		std::vector<uint32_t> dirtyCards;
+		size_t cardsCompacted = 0;
+
+		// Records the cards of the elements in [start, end).
+		void markCards(const size_t start, const size_t end);
+
+		void traceProperties(Tracer&);
+
+		const std::vector<Value>& dense() const { return shared ? shared->val : val; }
+
+		// Takes a copy of the elements of the template before a write.
+		void unshare() {
+			if (shared) {
+				val = shared->val;
+				shared = nullptr;
+			}
+		}
+
+		// Largest hole a write may leave in a dense array.
+		static constexpr size_t MAX_DENSE_GAP = 1024;
+
+		// A sparse array becomes dense again once this many percent
+		// of its elements are present.
+		static constexpr size_t MIN_DENSE_FILL = 50;
+
+		void setElement(const uint32_t index, const Value& value);
+		void makeSparse();
+		void makeDense();
 	};
 
-	class NumberObject : public Object {
+	class Shape;
+
+	/*
+		An object created by an object literal.
+
+		The keys of an object are described by its Shape, which it shares
+		with every other object that has the same keys in the same order,
+		and the object itself only stores the values, in slots. Objects
+		that get more keys than MAX_SHAPE_PROPERTIES, or any key computed
+		at runtime rather than written in the source, are unlikely to share
+		their shape with many others. They switch to a dictionary that
+		holds both keys and values instead.
+	*/
+	class PlainObject : public Object {
 	public:
-		NumberObject(const std::string& lexeme)
-			: Object(ObjectType::NUMBER), val(std::stod(lexeme)) {}
-			
-		NumberObject(const double &val)
-			: Object(ObjectType::NUMBER), val(val) {}
-			
+		PlainObject(Shape* shape)
+			: Object(ObjectType::OBJECT), shape(shape) {}
+
 		std::string toString() const;
-		double get() const { return val; }
-		void increment() { val++; }
-		void decrement() { val--; }
+		void trace(Tracer&);
+		bool traceSome(Tracer&, TraceCursor&, const size_t limit);
+		size_t footprint() const;
+		Object* relocate(void* memory) { return new (memory) PlainObject(std::move(*this)); }
+
+		// Null once the object is in dictionary mode.
+		Shape* getShape() const { return shape; }
+
+		/*
+			Slot access for inline caches, which have already checked
+			the shape of the object. addSlot() moves the object to the
+			given shape, which must be a transition of its current one.
+		*/
+		const Value& getSlot(const size_t slot) const { return slots[slot]; }
+		void setSlot(const size_t slot, const Value& value, Heap&);
+		void addSlot(Shape* transition, const Value& value, Heap&);
+
+		// Keys are interned, as for the named properties of arrays.
+		const Value get(const Value& property, const Heap&) const;
+		void set(const Value& property, const Value& value, Heap&);
 	private:
-		double val;
+		Shape* shape;
+		std::vector<Value> slots;
+		std::unique_ptr<PropertyDictionary> dictionary;
+
+		static constexpr size_t MAX_SHAPE_PROPERTIES = 64;
+
+		void makeDictionary();
 	};
 
-	class StringObject : public Object {
+	/*
+		Map and Set keep their entries in a ValueTable, in insertion
+		order. Like arrays, they only support their built-in methods,
+		see Natives.cpp, and have no named properties of their own.
+	*/
+	class MapObject : public Object {
 	public:
-		StringObject(const std::string& lexeme)
-			: Object(ObjectType::STRING), val(std::move(lexeme)) {}
+		MapObject()
+			: Object(ObjectType::MAP) {}
 
 		std::string toString() const;
-		std::string get() const { return val; }
+		void trace(Tracer& tracer) { table.trace(tracer); }
+		bool traceSome(Tracer& tracer, TraceCursor& cursor, const size_t limit) { return table.traceSome(tracer, cursor, limit); }
+		size_t footprint() const { return sizeof(MapObject) + table.footprint(); }
+		Object* relocate(void* memory) { return new (memory) MapObject(std::move(*this)); }
+
+		const Value* get(const Value& key) const { return table.find(key); }
+		void set(const Value& key, const Value& value, Heap&);
+		bool remove(const Value& key) { return table.remove(key); }
+		void clear() { table.clear(); }
+		size_t size() const { return table.size(); }
+
+		const ValueTable& getTable() const { return table; }
 	private:
-		std::string val;
+		ValueTable table;
 	};
 
-	class ArrayObject : public Object {
+	class SetObject : public Object {
 	public:
-		ArrayObject()
-			: Object(ObjectType::ARRAY) {}
+		SetObject()
+			: Object(ObjectType::SET) {}
 
 		std::string toString() const;
-		std::vector<std::shared_ptr<Object>> get() const { return val; }
+		void trace(Tracer& tracer) { table.trace(tracer); }
+		bool traceSome(Tracer& tracer, TraceCursor& cursor, const size_t limit) { return table.traceSome(tracer, cursor, limit); }
+		size_t footprint() const { return sizeof(SetObject) + table.footprint(); }
+		Object* relocate(void* memory) { return new (memory) SetObject(std::move(*this)); }
 
-		void push(const std::shared_ptr<Object>& obj) { val.push_back(obj); }
-		size_t length() const { return val.size(); }
+		bool has(const Value& value) const { return table.find(value) != nullptr; }
+		void add(const Value& value, Heap&);
+		bool remove(const Value& value) { return table.remove(value); }
+		void clear() { table.clear(); }
+		size_t size() const { return table.size(); }
 
-		const std::shared_ptr<Object> operator[] (const size_t index) const;
-		const std::shared_ptr<Object> operator[](const std::shared_ptr<Object>& property) const;
-		std::shared_ptr<Object>& operator[](const std::shared_ptr<Object>& property);
+		const ValueTable& getTable() const { return table; }
 	private:
-		std::vector<std::shared_ptr<Object>> val;
-		std::unordered_map<std::string, std::shared_ptr<Object>> props;
+		ValueTable table;
 	};
 
+	/*
+		Float64Array, Int32Array and Uint8Array. Elements are stored as
+		machine numbers in a RawBuffer, which may be a mapped file, and
+		are only boxed into Values when they are read. Stores convert
+		their value to the element type, wrapping integers around as
+		JavaScript does.
+
+		Typed arrays have a fixed length and no named properties, and
+		hold no Values, so the collector never needs to trace them.
+	*/
+	class TypedArrayObject : public Object {
+	public:
+		enum class ElementType : uint8_t {
+			FLOAT64,
+			INT32,
+			UINT8,
+		};
+
+		TypedArrayObject(const ElementType elementType, RawBuffer&& buffer)
+			: Object(ObjectType::TYPED_ARRAY), elementType(elementType),
+			  count(buffer.size() / elementSize(elementType)), buffer(std::move(buffer)) {}
+
+		std::string toString() const;
+		size_t footprint() const;
+		Object* relocate(void* memory) { return new (memory) TypedArrayObject(std::move(*this)); }
+
+		ElementType getElementType() const { return elementType; }
+		size_t length() const { return count; }
+		uint8_t* data() { return buffer.data(); }
+		const uint8_t* data() const { return buffer.data(); }
+
+		static size_t elementSize(const ElementType);
+		static const char* name(const ElementType);
+
+		Value getElement(const size_t index) const {
+			switch (elementType) {
+				case ElementType::FLOAT64: return Value::number(load<double>(index));
+				case ElementType::INT32: return Value::number(load<int32_t>(index));
+				default: return Value::number(load<uint8_t>(index));
+			}
+		}
+
+		void setElement(const size_t index, const double number) {
+			switch (elementType) {
+				case ElementType::FLOAT64: store<double>(index, number); break;
+				case ElementType::INT32: store<int32_t>(index, toInt32(number)); break;
+				default: store<uint8_t>(index, static_cast<uint8_t>(toInt32(number))); break;
+			}
+		}
+
+		/*
+			Fast paths for LDPROP and SETPROP, which only handle numeric
+			indices within bounds and return false for anything else.
+		*/
+		bool getIndexed(const Value& property, Value& element) const {
+			size_t index;
+			if (!toIndex(property, index)) return false;
+
+			element = getElement(index);
+			return true;
+		}
+
+		bool setIndexed(const Value& property, const Value& value) {
+			size_t index;
+			if (!toIndex(property, index) || !value.isNumber()) return false;
+
+			setElement(index, value.asNumber());
+			return true;
+		}
+
+		// ToNumber() for the values that have an obvious one, NaN for the rest.
+		static double toNumber(const Value&);
+
+		// Out-of-bounds reads are undefined and out-of-bounds writes are ignored.
+		const Value get(const Value& property, const Heap&) const;
+		void set(const Value& property, const Value& value, const Heap&);
+	private:
+		ElementType elementType;
+		size_t count;
+		RawBuffer buffer;
+
+		bool toIndex(const Value& property, size_t& index) const {
+			if (!property.isNumber()) return false;
+
+			const double position = property.asNumber();
+			if (!(position >= 0 && position < count)) return false;
+
+			index = static_cast<size_t>(position);
+			return index == position;
+		}
+
+		// Mapped files are not necessarily aligned to the element size.
+		template <typename T>
+		T load(const size_t index) const {
+			T element;
+			std::memcpy(&element, buffer.data() + index * sizeof(T), sizeof(T));
+			return element;
+		}
+
+		template <typename T>
+		void store(const size_t index, const T element) {
+			std::memcpy(buffer.data() + index * sizeof(T), &element, sizeof(T));
+		}
+
+		// ToInt32() from the spec: truncates and wraps around modulo 2^32.
+		static int32_t toInt32(const double number) {
+			if (number >= INT32_MIN && number <= INT32_MAX) return static_cast<int32_t>(number);
+			return wrapInt32(number);
+		}
+
+		static int32_t wrapInt32(const double number);
+	};
+
+	inline ObjectType Value::type() const {
+		if (isNumber()) return ObjectType::NUMBER;
+		if (isObject()) return asObject()->type;
+		if (isBoolean()) return ObjectType::BOOLEAN;
+		if (isNull()) return ObjectType::NULL_TYPE;
+		return ObjectType::UNDEFINED;
+	}
+
+	inline bool Value::isString() const {
+		return isObject() && asObject()->type == ObjectType::STRING;
+	}
+
+	inline bool Value::isArray() const {
+		return isObject() && asObject()->type == ObjectType::ARRAY;
+	}
+
+	inline bool Value::isPlainObject() const {
+		return isObject() && asObject()->type == ObjectType::OBJECT;
+	}
+
+	inline bool Value::isMap() const {
+		return isObject() && asObject()->type == ObjectType::MAP;
+	}
+
+	inline bool Value::isSet() const {
+		return isObject() && asObject()->type == ObjectType::SET;
+	}
+
+	inline bool Value::isTypedArray() const {
+		return isObject() && asObject()->type == ObjectType::TYPED_ARRAY;
+	}
+
+	inline bool Value::strictEquals(const Value& other) const {
+		if (isNumber() || other.isNumber()) {
+			return isNumber() && other.isNumber() && asNumber() == other.asNumber();
+		}
+
+		if (isIdentical(other)) return true;
+
+		if (!isString() || !other.isString()) return false;
+
+		// Two interned strings are only equal if they are the same object.
+		// Otherwise, distinct strings can still have the same contents.
+		const auto str = asString(), otherStr = other.asString();
+		if (str->isInterned() && otherStr->isInterned()) return false;
+
+		return str->equals(*otherStr);
+	}
+
+	inline bool Value::sameValueZero(const Value& other) const {
+		if (isNumber() && other.isNumber()) {
+			const auto x = asNumber(), y = other.asNumber();
+			return x == y || (x != x && y != y);
+		}
+
+		return strictEquals(other);
+	}
+
+	inline bool Value::isTruthy() const {
+		if (isNumber()) {
+			const auto number = asNumber();
+			return number != 0 && number == number;
+		}
+
+		if (isObject()) {
+			return !isString() || asString()->length() != 0;
+		}
+
+		// Of the remaining singletons, only true is truthy.
+		return isIdentical(Value::boolean(true));
+	}
+
+	inline StringObject* Value::asString() const {
+		return static_cast<StringObject*>(asObject());
+	}
+
+	inline ArrayObject* Value::asArray() const {
+		return static_cast<ArrayObject*>(asObject());
+	}
+
+	inline PlainObject* Value::asPlainObject() const {
+		return static_cast<PlainObject*>(asObject());
+	}
+
+	inline MapObject* Value::asMap() const {
+		return static_cast<MapObject*>(asObject());
+	}
+
+	inline SetObject* Value::asSet() const {
+		return static_cast<SetObject*>(asObject());
+	}
+
+	inline TypedArrayObject* Value::asTypedArray() const {
+		return static_cast<TypedArrayObject*>(asObject());
+	}
+
 } // namespace cu
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "Bytecode.h"
+
+namespace cu {
+
+	/*
+		Peephole optimizer, run over the bytecode once the Parser is done.
+		The Parser emits code in a single pass and never revisits it, thus
+		it leaves behind sequences that a second look can simplify:
+
+		- SETVAR n; POP becomes POPVAR n.
+		- NOT; JNT becomes JIT, when the condition is popped either way.
+		- A JNT on a constant becomes a JMP, or is dropped.
+		- A constant or variable that is loaded only to be popped is dropped,
+		  as is the copy that x++ loads when used as a statement.
+		- POPN 0, left by blocks that declare nothing, is dropped.
+		- A jump to a jump goes straight to where the latter lands.
+		- Code that no jump reaches after a JMP, LOOP or RET is dropped.
+
+		The bytecode is decoded into instructions, with jumps pointing at
+		instructions rather than offsets, and encoded back once no pattern
+		matches anymore, along with its location info.
+	*/
+	class Optimizer {
+	public:
+		void optimize(Bytecode&);
+	private:
+		struct Instruction {
+			OpCode opcode;
+
+			// The first operand. For jumps, the index of the instruction
+			// they land on, and LOOP is a JMP that lands behind itself.
+			size_t operand = 0;
+
+			// The second operand of NEWTYPED, INVOKE and register operations.
+			byte second = 0;
+
+			// Where the instruction was, and how long it was, as parsed.
+			size_t offset;
+			size_t length;
+
+			// Whether a jump lands on the instruction.
+			bool isTarget = false;
+			bool removed = false;
+		};
+
+		std::vector<Instruction> code;
+
+		// The location of every byte, as parsed.
+		std::vector<Location> locations;
+
+		bool decode(const Bytecode&);
+		void encode(Bytecode&) const;
+
+		bool threadJumps();
+		bool foldConstantConditions(const Bytecode&);
+		bool fuseInstructions();
+		bool removeUnreachable();
+
+		// Drops the removed instructions. Jumps that landed on one
+		// land on the next instruction that is left.
+		void compact();
+		void findTargets();
+	};
+
+} // namespace cu
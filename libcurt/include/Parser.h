@@ -21,6 +21,7 @@
 
 #include "Bytecode.h"
 #include "Environment.h"
+#include "Heap.h"
 #include "Token.h"
 #include "TranslationUnit.h"
 
@@ -28,6 +29,8 @@ namespace cu {
 	
 	class Parser {
 	public:
+		Parser(Heap& heap) : heap(heap) {}
+
 		bool parse(TranslationUnit& translationUnit, std::vector<Token>& tokens);
 		void reset();
 		Bytecode getBytecode() const;
@@ -38,10 +41,10 @@ namespace cu {
 
 		// TODO: Documentation needed
 		struct LoopJumpOffsets {
-			byte continueOffset;
-			std::vector<byte> breakPatches;
+			size_t continueOffset;
+			std::vector<size_t> breakPatches;
 
-			LoopJumpOffsets(const byte& continueOffset) :
+			LoopJumpOffsets(const size_t& continueOffset) :
 				continueOffset(continueOffset) {}
 		};
 
@@ -51,6 +54,7 @@ namespace cu {
 
 		Bytecode bytecode;
 		Environment env;
+		Heap& heap;
 
 		const Token& previous() const;
 		const Token& peek() const;
@@ -59,7 +63,8 @@ namespace cu {
 		bool match(TokenType);
 		bool atEOF() const;
 
-		byte emitJump(OpCode);
+		size_t emitJump(OpCode);
+		bool patchJump(const size_t jumpOffset);
 
 		void synchronize();
 
@@ -92,12 +97,33 @@ namespace cu {
 		bool primary();
 		bool grouping();
 		bool array();
+		bool constantArray();
+		bool object();
+		bool construct();
 		bool stringTemplate();
 		bool identifier();
 		bool memberAccess(const Token& identifierToken);
+		bool methodCall(const Token& nameToken, const size_t nameOffset);
 		bool variableReference(const Token& identifierToken);
 		bool postUnary(const Token& identifierToken);
 
+		/*
+			Binary operators by how tightly they bind, loosest first.
+			Operators of other tokens have no precedence.
+		*/
+		enum class Precedence { NONE, EQUALITY, COMPARISON, TERM, FACTOR, EXPONENT };
+		static Precedence precedence(const TokenType);
+		static bool endsOperand(const TokenType, const Precedence);
+
+		/*
+			Emits a register instruction, such as ADDR, for a binary
+			operation of the given precedence if both its operands are
+			variables or numbers. Returns false, without consuming any
+			tokens, if they are not.
+		*/
+		bool registerBinary(const Precedence);
+		int registerOperand(const Token&);
+
 		void error(const std::string &) const;
 	};
 
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Value.h"
+
+namespace cu {
+
+	/*
+		Named properties of an object, keyed by interned strings.
+
+		Entries are kept in a vector in the order they were added, which
+		is the order they are printed in. The hash table only maps keys
+		to positions in that vector. It is laid out like a Swiss table:
+		a control byte per slot holds either EMPTY or 7 bits of the hash
+		of the key in that slot, and slots are probed a group of
+		GROUP_WIDTH at a time. With SSE2, a group is checked against the
+		hash with a single compare.
+
+		Keys are compared by address, since equal interned strings are
+		the same object. Properties are never removed, thus there are no
+		tombstones.
+	*/
+	class PropertyDictionary {
+	public:
+		struct Entry {
+			const StringObject* key;
+			Value value;
+		};
+
+		// Returns the value of the key, or nullptr if it is absent.
+		const Value* find(const StringObject* key) const;
+
+		// Sets the value of the key, adding it after all others if absent.
+		void set(const StringObject* key, const Value& value);
+
+		size_t size() const { return entries.size(); }
+
+		// Bytes allocated for the entries and the table.
+		size_t footprint() const;
+
+		std::vector<Entry>::iterator begin() { return entries.begin(); }
+		std::vector<Entry>::iterator end() { return entries.end(); }
+		std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+		std::vector<Entry>::const_iterator end() const { return entries.end(); }
+	private:
+		std::vector<Entry> entries;
+		std::vector<int8_t> control;
+		std::vector<uint32_t> slots;
+
+		static constexpr int8_t EMPTY = -128;
+		static constexpr size_t GROUP_WIDTH = 16;
+		static constexpr size_t INITIAL_CAPACITY = 16;
+
+		// Maximum load, in percent, before the table grows.
+		static constexpr size_t MAX_LOAD = 87;
+
+		static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+		size_t indexOf(const StringObject* key, const uint64_t hash) const;
+		void place(const uint64_t hash, const uint32_t index);
+		void rehash(const size_t capacity);
+	};
+
+} // namespace cu
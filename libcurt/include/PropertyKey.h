@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Value.h"
+
+namespace cu {
+
+	class Heap;
+
+	/*
+		A property in canonical form: either an array index, an integer
+		in [0, 2^32 - 2], or a name, which is an interned string.
+
+		Numbers and strings that name the same property, such as 1 and
+		"1", have the same key. Any other value is named by its string
+		form. Interned strings know whether they are an index, so most
+		keys are canonicalized without even looking at their characters.
+	*/
+	class PropertyKey {
+	public:
+		// Interns the name of the property if needed.
+		static PropertyKey from(const Value& property, Heap&);
+
+		/*
+			Like from(), but never allocates. A name that was not already
+			interned cannot be the key of any property, so its key has
+			neither an index nor a name.
+		*/
+		static PropertyKey find(const Value& property, const Heap&);
+
+		bool isIndex() const { return indexed; }
+		uint32_t getIndex() const { return index; }
+
+		/*
+			The name of a named property. For an index, this is its string
+			form if the property was given as a string, nullptr otherwise,
+			see toName().
+		*/
+		StringObject* getName() const { return name; }
+
+		// The property as a name, for objects that do not have elements.
+		StringObject* toName(Heap&) const;
+		StringObject* findName(const Heap&) const;
+
+		static bool toIndex(const double number, uint32_t& index);
+	private:
+		PropertyKey(StringObject* name) : name(name), index(0), indexed(false) {}
+		PropertyKey(const uint32_t index, StringObject* name = nullptr)
+			: name(name), index(index), indexed(true) {}
+
+		StringObject* name;
+		uint32_t index;
+		bool indexed;
+	};
+
+} // namespace cu
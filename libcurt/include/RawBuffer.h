@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cu {
+
+	/*
+		Contiguous bytes owned by a typed array, allocated outside the Heap.
+
+		A buffer either owns zero-filled memory or a private mapping of a
+		file. Writes to a mapped buffer only change the process' copy of
+		the pages that were written, never the file, so a large file can
+		be read without parsing or copying it up front.
+	*/
+	class RawBuffer {
+	public:
+		RawBuffer() = default;
+		RawBuffer(RawBuffer&&);
+		RawBuffer& operator=(RawBuffer&&);
+		RawBuffer(const RawBuffer&) = delete;
+		RawBuffer& operator=(const RawBuffer&) = delete;
+		~RawBuffer() { release(); }
+
+		// Zero-filled buffer of the given number of bytes.
+		static RawBuffer allocate(const size_t size);
+
+		// Returns false with a message in error if the file cannot be mapped.
+		static bool map(const std::string& path, RawBuffer& buffer, std::string& error);
+
+		uint8_t* data() const { return bytes; }
+		size_t size() const { return length; }
+		bool isMapped() const { return mapped; }
+	private:
+		uint8_t* bytes = nullptr;
+		size_t length = 0;
+		bool mapped = false;
+
+		void release();
+	};
+
+} // namespace cu
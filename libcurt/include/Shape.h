@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Object.h"
+
+namespace cu {
+
+	/*
+		The layout of a PlainObject: which keys it has, in which order,
+		and thus which slot holds the value of each key.
+
+		Shapes form a tree rooted at the empty shape. Adding a key to an
+		object moves it to a child of its current shape, and that child is
+		shared by every object that adds the same key to the same shape.
+		Objects created from the same literal, or filled in the same order,
+		thus end up with the same shape and store nothing but their values.
+
+		Shapes are tenured objects of the Heap, which also keeps the edges
+		from parents to children, see Heap::addProperty(). Those edges are
+		weak: a shape lives for as long as an object or an inline cache
+		refers to it, or one of its children does. Each shape only traces
+		its parent and the key that it adds.
+	*/
+	class Shape : public Object {
+	public:
+		// The empty shape.
+		Shape()
+			: Object(ObjectType::SHAPE) {}
+
+		Shape(Shape* parent, StringObject* key);
+
+		std::string toString() const;
+		void trace(Tracer&);
+		size_t footprint() const;
+		Object* relocate(void* memory) { return new (memory) Shape(std::move(*this)); }
+
+		// Returns the slot of the key, or NOT_FOUND.
+		size_t lookup(const StringObject* key) const;
+
+		size_t propertyCount() const { return keys.size(); }
+
+		// Keys in the order that they were added, by slot.
+		const std::vector<StringObject*>& getKeys() const { return keys; }
+
+		static constexpr size_t NOT_FOUND = SIZE_MAX;
+	private:
+		Shape* parent = nullptr;
+		std::vector<StringObject*> keys;
+
+		// Maps keys to slots for shapes too large to scan.
+		std::unordered_map<const StringObject*, size_t> index;
+
+		// Shapes with more keys than this are looked up in index.
+		static constexpr size_t MAX_LINEAR_LOOKUP = 8;
+	};
+
+} // namespace cu
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace cu {
+
+	/*
+		Allocator for the Heap's old space.
+
+		Requests are rounded up to a multiple of 8 bytes, which gives every
+		Object subclass a size class of its own. Each size class carves its
+		cells out of 16 KB slabs and keeps a free list of the cells that
+		were released. Objects of the same type thus end up next to each
+		other instead of being scattered across the malloc heap.
+
+		Requests larger than the biggest size class go to operator new.
+	*/
+	class SlabAllocator {
+	public:
+		SlabAllocator() = default;
+		SlabAllocator(const SlabAllocator&) = delete;
+		SlabAllocator& operator=(const SlabAllocator&) = delete;
+		~SlabAllocator();
+
+		void* allocate(const size_t size);
+		void free(void* memory, const size_t size);
+
+		void printStats(std::ostream&) const;
+	private:
+		struct FreeCell {
+			FreeCell* next;
+		};
+
+		struct SizeClass {
+			FreeCell* freeList = nullptr;
+
+			// Part of the newest slab that has never been handed out.
+			char* cursor = nullptr;
+			char* end = nullptr;
+
+			std::vector<char*> slabs;
+			size_t liveCells = 0;
+		};
+
+		static constexpr size_t GRANULE = 8;
+		static constexpr size_t MAX_CELL_SIZE = 256;
+		static constexpr size_t SLAB_SIZE = 16 * 1024;
+		static constexpr size_t SIZE_CLASS_COUNT = MAX_CELL_SIZE / GRANULE;
+
+		SizeClass sizeClasses[SIZE_CLASS_COUNT];
+
+		size_t largeObjects = 0;
+		size_t largeBytes = 0;
+
+		static size_t sizeClassIndex(const size_t size) {
+			return (size + GRANULE - 1) / GRANULE - 1;
+		}
+
+		static size_t cellSize(const size_t index) {
+			return (index + 1) * GRANULE;
+		}
+	};
+
+} // namespace cu
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Object.h"
+
+namespace cu {
+
+	/*
+		Set of the Heap's interned strings, keyed by their code units.
+
+		An open-addressing table with linear probing. Entries are only
+		ever removed in bulk by removeIf(), which rebuilds the table, so
+		there is no need for tombstones.
+
+		The table does not keep its strings alive: the Heap removes the
+		ones that did not survive marking before sweeping them.
+	*/
+	class StringTable {
+	public:
+		StringObject* find(const StringUnits& units, const bool twoByte, const uint64_t hash) const;
+
+		// The string must not already be in the table.
+		void insert(StringObject*);
+
+		void removeIf(const std::function<bool(const StringObject*)>& predicate);
+
+		size_t size() const { return count; }
+	private:
+		std::vector<StringObject*> entries;
+		size_t count = 0;
+
+		static constexpr size_t INITIAL_CAPACITY = 64;
+
+		// Maximum load, in percent, before the table grows.
+		static constexpr size_t MAX_LOAD = 75;
+
+		void rehash(const size_t capacity);
+		void place(StringObject*);
+	};
+
+} // namespace cu
@@ -16,11 +16,11 @@
 
 #pragma once
 
-#include <memory>
 #include <vector>
 #include <unordered_map>
 
 #include "Bytecode.h"
+#include "Heap.h"
 #include "TranslationUnit.h"
 
 // #define TRACE_EXECUTION
@@ -42,13 +42,16 @@ namespace cu {
 
 	class VM {
 	public:
+		VM(Heap& heap) : heap(heap) {}
+
 		int run(const Bytecode&, const TranslationUnit&);
 	private:
-		Stack<std::shared_ptr<Object>> stack;
-
-		size_t ip = 0;
+		Heap& heap;
+		Stack<Value> stack;
 
-		void error(const TranslationUnit&, const Bytecode& bytecode, const std::string& msg) const;
+		void error(const TranslationUnit&, const Bytecode& bytecode, const size_t ip, const std::string& msg) const;
+		void collectGarbage(const Bytecode&);
+		Value concatenate(const Value& left, const Value& right);
 	};
 
 } // namespace cu
\ No newline at end of file
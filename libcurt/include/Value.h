@@ -0,0 +1,162 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace cu {
+
+	enum class ObjectType {
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT,
+		MAP,
+		SET,
+		TYPED_ARRAY,
+		SHAPE,
+		UNDEFINED,
+		NULL_TYPE,
+	};
+
+	class Object;
+	class StringObject;
+	class ArrayObject;
+	class PlainObject;
+	class MapObject;
+	class SetObject;
+	class TypedArrayObject;
+
+	/*
+		A Value is a NaN-boxed 64-bit word.
+
+		Any double that is not a quiet NaN with our tag bits set is stored
+		as-is. Everything else lives in the unused NaN space:
+
+		- booleans, null and undefined are small tags in the low bits
+		- heap objects (strings, arrays, objects, maps, sets, typed arrays) are pointers with the sign bit set
+
+		This lets the VM push, pop and copy values without touching the
+		heap or any reference counts. Only strings, arrays and objects are
+		allocated.
+
+		  sign  exponent (11)  q  tag  payload (48)
+		  [0]   [11111111111]  [1][1]  [ ... 00000000001 ]  null
+		  [1]   [11111111111]  [1][1]  [ ... pointer     ]  object
+	*/
+	class Value {
+	public:
+		Value() : bits(QNAN | TAG_UNDEFINED) {}
+
+		static Value number(const double val) {
+			// Canonicalize NaNs so that none of them can be
+			// mistaken for a tagged value.
+			if (val != val) return Value(CANONICAL_NAN);
+
+			uint64_t bits;
+			std::memcpy(&bits, &val, sizeof(double));
+			return Value(bits);
+		}
+
+		static Value boolean(const bool val) { return Value(QNAN | (val ? TAG_TRUE : TAG_FALSE)); }
+		static Value null() { return Value(QNAN | TAG_NULL); }
+		static Value undefined() { return Value(QNAN | TAG_UNDEFINED); }
+
+		static Value object(const Object* obj) {
+			return Value(SIGN_BIT | QNAN | (uint64_t)(uintptr_t) obj);
+		}
+
+		bool isNumber() const { return (bits & QNAN) != QNAN; }
+		bool isBoolean() const { return (bits | 1) == (QNAN | TAG_TRUE); }
+		bool isNull() const { return bits == (QNAN | TAG_NULL); }
+		bool isUndefined() const { return bits == (QNAN | TAG_UNDEFINED); }
+		bool isObject() const { return (bits & (SIGN_BIT | QNAN)) == (SIGN_BIT | QNAN); }
+
+		/*
+			true, false, null and undefined each have exactly one bit pattern
+			and objects are compared by address, so for anything that is not
+			a number, identical bits mean the same value. Numbers need care:
+			NaN is not equal to itself and 0 equals -0.
+		*/
+		bool isIdentical(const Value& other) const { return bits == other.bits; }
+
+		// Raw representation, used to deduplicate constants.
+		uint64_t getBits() const { return bits; }
+
+		/*
+			=== and SameValueZero, which differ only in that the latter,
+			used by Map, Set and includes(), finds NaN. Defined in Object.h
+			since strings are compared by their contents.
+		*/
+		inline bool strictEquals(const Value& other) const;
+		inline bool sameValueZero(const Value& other) const;
+
+		// Whether a condition on the value holds, as for JNT.
+		inline bool isTruthy() const;
+
+		// Defined in Object.h since they need the complete Object type.
+		inline bool isString() const;
+		inline bool isArray() const;
+		inline bool isPlainObject() const;
+		inline bool isMap() const;
+		inline bool isSet() const;
+		inline bool isTypedArray() const;
+
+		double asNumber() const {
+			double val;
+			std::memcpy(&val, &bits, sizeof(double));
+			return val;
+		}
+
+		bool asBoolean() const { return bits == (QNAN | TAG_TRUE); }
+
+		Object* asObject() const {
+			return (Object*)(uintptr_t)(bits & ~(SIGN_BIT | QNAN));
+		}
+
+		inline StringObject* asString() const;
+		inline ArrayObject* asArray() const;
+		inline PlainObject* asPlainObject() const;
+		inline MapObject* asMap() const;
+		inline SetObject* asSet() const;
+		inline TypedArrayObject* asTypedArray() const;
+
+		inline ObjectType type() const;
+		std::string toString() const;
+
+		static std::string numberToString(const double);
+	private:
+		explicit Value(const uint64_t bits) : bits(bits) {}
+
+		static constexpr uint64_t SIGN_BIT		= 0x8000000000000000;
+		static constexpr uint64_t QNAN			= 0x7ffc000000000000;
+		static constexpr uint64_t CANONICAL_NAN	= 0x7ff8000000000000;
+
+		static constexpr uint64_t TAG_NULL		= 1;
+		static constexpr uint64_t TAG_FALSE		= 2;
+		static constexpr uint64_t TAG_TRUE		= 3;
+		static constexpr uint64_t TAG_UNDEFINED	= 4;
+
+		uint64_t bits;
+	};
+
+	static_assert(sizeof(Value) == sizeof(uint64_t), "Value must fit in a 64-bit word");
+
+} // namespace cu
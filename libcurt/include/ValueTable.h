@@ -0,0 +1,104 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Value.h"
+
+namespace cu {
+
+	class Tracer;
+	struct TraceCursor;
+
+	/*
+		Hash table keyed by Values, which backs Map and Set.
+
+		Keys are compared with SameValueZero, as in JavaScript: numbers
+		by value, with NaN equal to itself and 0 equal to -0, strings by
+		their contents, and everything else by identity. Numbers, booleans
+		and strings are hashed as they are, without being converted to
+		strings first.
+
+		Entries are kept in a vector in insertion order. The table itself
+		maps hashes to positions in that vector with linear probing. A
+		removed entry stays in the vector, marked as such, until the next
+		rebuild, so its slot doubles as a tombstone.
+	*/
+	class ValueTable {
+	public:
+		struct Entry {
+			Value key;
+			Value value;
+			bool removed;
+		};
+
+		// Returns the value of the key, or nullptr if it is absent.
+		const Value* find(const Value& key) const;
+
+		// Sets the value of the key, adding it after all others if absent.
+		void set(const Value& key, const Value& value);
+
+		// Returns whether the key was present.
+		bool remove(const Value& key);
+
+		void clear();
+
+		size_t size() const { return count; }
+
+		// Bytes allocated for the entries and the table.
+		size_t footprint() const;
+
+		// All entries, in insertion order, including removed ones.
+		const std::vector<Entry>& getEntries() const { return entries; }
+
+		/*
+			Visits every key and value. Objects other than strings are
+			hashed by address, so the table is rebuilt if the collector
+			moved any of them.
+		*/
+		void trace(Tracer&);
+
+		// Like trace(), but in steps, for tracers that never move objects.
+		bool traceSome(Tracer&, TraceCursor&, const size_t limit);
+	private:
+		std::vector<Entry> entries;
+		std::vector<uint32_t> slots;
+		size_t count = 0;
+
+		// Bumped whenever entries may have moved to other positions.
+		size_t layout = 0;
+
+		static constexpr uint32_t EMPTY = UINT32_MAX;
+		static constexpr size_t INITIAL_CAPACITY = 16;
+
+		// Maximum load, in percent, before the table is rebuilt.
+		static constexpr size_t MAX_LOAD = 75;
+
+		static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+		static uint64_t hashOf(const Value&);
+
+		size_t indexOf(const Value& key, const uint64_t hash) const;
+		void place(const uint64_t hash, const uint32_t index);
+
+		// Drops removed entries and rehashes the rest.
+		void rebuild(const size_t capacity);
+	};
+
+} // namespace cu
@@ -14,60 +14,206 @@
  * limitations under the License.
  */
 
-#include <iostream>
-
 #include "Bytecode.h"
 
 namespace cu {
 
-	void Bytecode::emit(byte opcode, const Location& loc) {
-		blob.push_back(opcode);
-		locationInfo.add(loc);
+	void Bytecode::emit(const OpCode opcode, const Location& loc) {
+		emitByte(opcode, loc);
+	}
+
+	void Bytecode::emit(const OpCode opcode, const size_t operand, const Location& loc) {
+		if (operand > UINT8_MAX) {
+			emitByte(OpCode::WIDE, loc);
+			emitByte(opcode, loc);
+			emitWord(operand, loc);
+		} else {
+			emitByte(opcode, loc);
+			emitByte(operand, loc);
+		}
+	}
+
+	void Bytecode::emit(const OpCode opcode, const size_t operand, const byte second, const Location& loc) {
+		emit(opcode, operand, loc);
+		emitByte(second, loc);
+	}
+
+	size_t Bytecode::emitJump(const OpCode opcode, const Location& loc) {
+		emitByte(OpCode::WIDE, loc);
+		emitByte(opcode, loc);
+		emitWord(UINT32_MAX, loc);
+		return blob.size() - 4;
+	}
+
+	bool Bytecode::patchJump(const size_t jumpOffset) {
+		const size_t distance = blob.size() - (jumpOffset + 4);
+		if (distance > UINT32_MAX) return false;
+
+		for (int i = 0; i < 4; i++) {
+			blob[jumpOffset + i] = (distance >> (i * 8)) & 0xFF;
+		}
+
+		return true;
 	}
 
-	void Bytecode::emit(byte b1, byte b2, const Location& loc) {
-		emit(b1, loc);
-		emit(b2, loc);
+	void Bytecode::emitLoop(const size_t target, const Location& loc) {
+		// Distances are counted from the end of the LOOP instruction.
+		const size_t distance = blob.size() + 3 - target;
+
+		if (distance > UINT16_MAX) {
+			emitByte(OpCode::WIDE, loc);
+			emitByte(OpCode::LOOP, loc);
+			emitWord(distance + 3, loc);
+		} else {
+			emitByte(OpCode::LOOP, loc);
+			emitByte(distance & 0xFF, loc);
+			emitByte(distance >> 8, loc);
+		}
 	}
 
-	size_t Bytecode::addConstant(const Object* constant) {
-		switch (constant->type) {
-			case ObjectType::BOOLEAN:
-				constants.push_back(std::shared_ptr<BooleanObject>((BooleanObject*)constant));
-				break;
-			case ObjectType::NUMBER:
-				constants.push_back(std::shared_ptr<NumberObject>((NumberObject*)constant));
-				break;
-			case ObjectType::STRING:
-				constants.push_back(std::shared_ptr<StringObject>((StringObject*)constant));
-				break;
-			case ObjectType::UNDEFINED:
-			case ObjectType::NULL_TYPE:
-				constants.push_back(std::shared_ptr<EmptyObject>((EmptyObject*)constant));
-				break;
+	// The number of bytes taken by the operands of an instruction.
+	static size_t operandLength(const OpCode opcode, const bool wide) {
+		switch (opcode) {
+			case LDC: case POPN: case LDVAR: case SETVAR: case POPVAR:
+			case NEWARR: case CLONEARR: case NEWOBJ: case NEWMAP: case NEWSET:
+			case SETPROP: case LDPROP: case INCVAR: case DECVAR:
+				return wide ? 4 : 1;
+			case NEWTYPED: case INVOKE:
+				return wide ? 5 : 2;
+			case JMP: case JNT: case JIT: case LOOP:
+				return wide ? 4 : 2;
+			case ADDR: case SUBR: case MULR: case DIVR: case MODR:
+			case GRTR: case LSTR: case GRER: case LSER: case EQUR: case NEQR:
+				return 2;
 			default:
-				// TODO: Get rid of this eventually
-				std::cout << "addConstant case missing: " << (int) constant->type << std::endl;
-				std::exit(1);
+				return 0;
 		}
+	}
 
-		return constants.size() - 1;
+	void Bytecode::shrinkJumps() {
+		struct Jump {
+			OpCode opcode;
+			size_t offset;
+			size_t length;
+			size_t target;
+			bool narrow;
+		};
+
+		// Every jump, with the offset it lands on. A wide one can take two
+		// bytes if its distance fits as it is now, as that only gets shorter.
+		std::vector<Jump> jumps;
+		bool shrinks = false;
+
+		for (size_t ip = 0; ip < blob.size();) {
+			const size_t start = ip;
+			const bool wide = blob[ip] == WIDE;
+			if (wide) ip++;
+
+			const auto opcode = static_cast<OpCode>(blob[ip++]);
+			ip += operandLength(opcode, wide);
+
+			if (opcode != JMP && opcode != JNT && opcode != JIT && opcode != LOOP) continue;
+
+			const size_t distance = wide ? readWord(&blob[ip - 4]) : readShort(&blob[ip - 2]);
+			Jump jump = { opcode, start, ip - start, opcode == LOOP ? ip - distance : ip + distance, false };
+
+			if (wide) {
+				jump.narrow = opcode == LOOP ? start + 3 - jump.target <= UINT16_MAX
+					: jump.target - (start + 3) <= UINT16_MAX;
+				shrinks |= jump.narrow;
+			}
+
+			jumps.push_back(jump);
+		}
+
+		if (!shrinks) return;
+
+		// Offsets move back by three bytes for every jump narrowed before them.
+		std::vector<size_t> offsets(blob.size() + 1);
+		size_t shift = 0;
+		size_t next = 0;
+
+		for (size_t ip = 0; ip <= blob.size(); ip++) {
+			if (next < jumps.size() && jumps[next].offset < ip) {
+				if (jumps[next].narrow) shift += 3;
+				next++;
+			}
+
+			offsets[ip] = ip - shift;
+		}
+
+		std::vector<byte> parsed;
+		parsed.swap(blob);
+
+		const auto locations = locationInfo.expand();
+		locationInfo.clear();
+
+		next = 0;
+		for (size_t ip = 0; ip < parsed.size();) {
+			if (next == jumps.size() || jumps[next].offset != ip) {
+				emitByte(parsed[ip], locations[ip]);
+				ip++;
+				continue;
+			}
+
+			const auto& jump = jumps[next++];
+			const auto& loc = locations[ip + jump.length - 1];
+			const size_t length = jump.narrow || jump.length == 3 ? 3 : 6;
+
+			const size_t end = offsets[ip] + length;
+			const size_t target = offsets[jump.target];
+			const size_t distance = jump.opcode == LOOP ? end - target : target - end;
+
+			if (length == 3) {
+				emitByte(jump.opcode, loc);
+				emitByte(distance & 0xFF, loc);
+				emitByte(distance >> 8, loc);
+			} else {
+				emitByte(OpCode::WIDE, loc);
+				emitByte(jump.opcode, loc);
+				emitWord(distance, loc);
+			}
+
+			ip += jump.length;
+		}
 	}
 
-	Location Bytecode::getSourceLocation(byte bytecodeOffset) const {
-		return locationInfo.get(bytecodeOffset);
+	void Bytecode::emitByte(const byte b, const Location& loc) {
+		blob.push_back(b);
+		locationInfo.add(loc);
 	}
 
-	void Bytecode::patch(const size_t offset, const byte b) {
-		if (offset < blob.size()) {
-			blob[offset] = b;
+	void Bytecode::emitWord(const uint32_t word, const Location& loc) {
+		for (int shift = 0; shift < 32; shift += 8) {
+			emitByte((word >> shift) & 0xFF, loc);
 		}
 	}
 
+	size_t Bytecode::addConstant(const Value& constant) {
+		const auto it = constantOffsets.find(constant.getBits());
+		if (it != constantOffsets.end()) return it->second;
+
+		constantOffsets[constant.getBits()] = constants.size();
+
+		constants.push_back(constant);
+		return constants.size() - 1;
+	}
+
+	size_t Bytecode::addPropertyCache() {
+		propertyCaches.emplace_back();
+		return propertyCaches.size() - 1;
+	}
+
+	Location Bytecode::getSourceLocation(size_t bytecodeOffset) const {
+		return locationInfo.get(bytecodeOffset);
+	}
+
 	void Bytecode::clear() {
 		blob.clear();
 		locationInfo.clear();
 		constants.clear();
+		constantOffsets.clear();
+		propertyCaches.clear();
 	}
 
 } // namespace cu
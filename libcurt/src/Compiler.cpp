@@ -18,6 +18,7 @@
 
 #include "Compiler.h"
 #include "Disassembler.h"
+#include "Optimizer.h"
 #include "Tokenizer.h"
 
 namespace cu {
@@ -51,9 +52,12 @@ namespace cu {
 			return false;
 		}
 
+		bytecode = parser.getBytecode();
+		if (optimize) Optimizer().optimize(bytecode);
+
 #ifdef DISASSEMBLE
 		cu::Disassembler disassembler;
-		disassembler.disassemble(parser.getBytecode(), translationUnit);
+		disassembler.disassemble(bytecode, translationUnit);
 #endif
 
 		return true;
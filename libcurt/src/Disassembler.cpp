@@ -23,55 +23,123 @@ namespace cu {
 
 	void Disassembler::disassemble(const Bytecode &bytecode, const TranslationUnit &translationUnit) {
 
-#define GET_CONST(index) bytecode.constants[bytecode.blob[index]]
 
 		// Printing the source of the bytecode
 		std::cout << ANSICodes::BOLD << ANSICodes::WHITE;
 		std::cout << translationUnit.filepath << ANSICodes::RESET << std::endl;
 
 		for (ip = 0; ip < bytecode.blob.size(); ip++) {
+			// A WIDE prefix is shown as part of the instruction it widens.
+			if (!wide) offset = ip;
+
 			switch (bytecode.blob[ip]) {
 				case LDC: {
-					Object* val = GET_CONST(++ip).get();
-					printInstruction("LDC", std::to_string((int) bytecode.blob[ip]), val->toString());
+					const auto index = readOperand(bytecode);
+					printInstruction("LDC", std::to_string(index), bytecode.constants[index].toString());
 					break;
 				}
 
 				case POP: printInstruction("POP"); break;
 
 				case POPN: {
-					printInstruction("POPN", std::to_string((int) bytecode.blob[++ip]));
+					printInstruction("POPN", std::to_string(readOperand(bytecode)));
 					break;
 				}
 
 				case LDVAR: {
-					printInstruction("LDVAR", std::to_string((int)bytecode.blob[++ip]));
+					printInstruction("LDVAR", std::to_string(readOperand(bytecode)));
 					break;
 				}
 
 				case SETVAR: {
-					printInstruction("SETVAR", std::to_string((int)bytecode.blob[++ip]));
+					printInstruction("SETVAR", std::to_string(readOperand(bytecode)));
+					break;
+				}
+
+				case POPVAR: {
+					printInstruction("POPVAR", std::to_string(readOperand(bytecode)));
 					break;
 				}
 
 				case NEWARR: {
-					printInstruction("NEWARR", std::to_string((int)bytecode.blob[++ip]));
+					printInstruction("NEWARR", std::to_string(readOperand(bytecode)));
+					break;
+				}
+
+				case CLONEARR: {
+					const auto index = readOperand(bytecode);
+					printInstruction("CLONEARR", std::to_string(index), bytecode.constants[index].toString());
+					break;
+				}
+
+				case NEWOBJ: {
+					printInstruction("NEWOBJ", std::to_string(readOperand(bytecode)));
 					break;
 				}
 
-				case SETPROP: printInstruction("SETPROP"); break;
-				case LDPROP: printInstruction("LDPROP"); break;
+				case NEWMAP: {
+					printInstruction("NEWMAP", std::to_string(readOperand(bytecode)));
+					break;
+				}
 
+				case NEWSET: {
+					printInstruction("NEWSET", std::to_string(readOperand(bytecode)));
+					break;
+				}
+
+				case NEWTYPED: {
+					const auto elementType = static_cast<TypedArrayObject::ElementType>(readOperand(bytecode));
+					const auto argCount = std::to_string(readOperand(bytecode));
+					printInstruction("NEWTYPED", std::to_string((int) elementType) + " " + argCount,
+						TypedArrayObject::name(elementType));
+					break;
+				}
+
+				case SETPROP: {
+					printInstruction("SETPROP", std::to_string(readOperand(bytecode)));
+					break;
+				}
+
+				case LDPROP: {
+					printInstruction("LDPROP", std::to_string(readOperand(bytecode)));
+					break;
+				}
+
+				case INVOKE: {
+					const auto nameOffset = readOperand(bytecode);
+					const auto argCount = std::to_string(readOperand(bytecode));
+					printInstruction("INVOKE", std::to_string(nameOffset) + " " + argCount,
+						bytecode.constants[nameOffset].toString());
+					break;
+				}
+
+				// Jumps show their distance, and the offset they land on.
 				case JMP: {
-					printInstruction("JMP", std::to_string((int) bytecode.blob[++ip]));
+					const auto distance = readJump(bytecode);
+					printInstruction("JMP", std::to_string(distance), "to " + std::to_string(ip + 1 + distance));
 					break;
 				}
 
 				case JNT: {
-					printInstruction("JNT", std::to_string((int) bytecode.blob[++ip]));
+					const auto distance = readJump(bytecode);
+					printInstruction("JNT", std::to_string(distance), "to " + std::to_string(ip + 1 + distance));
 					break;
 				}
 
+				case JIT: {
+					const auto distance = readJump(bytecode);
+					printInstruction("JIT", std::to_string(distance), "to " + std::to_string(ip + 1 + distance));
+					break;
+				}
+
+				case LOOP: {
+					const auto distance = readJump(bytecode);
+					printInstruction("LOOP", std::to_string(distance), "to " + std::to_string(ip + 1 - distance));
+					break;
+				}
+
+				case WIDE: wide = true; break;
+
 				// Arithmetic
 				case ADD: printInstruction("ADD"); break;
 				case SUB: printInstruction("SUB"); break;
@@ -97,17 +165,67 @@ namespace cu {
 				case OR: printInstruction("OR"); break;
 				case NOT: printInstruction("NOT"); break;
 
+				case INCVAR: printInstruction("INCVAR", std::to_string(readOperand(bytecode))); break;
+				case DECVAR: printInstruction("DECVAR", std::to_string(readOperand(bytecode))); break;
+
+				// Register operations
+				case ADDR: printRegisterInstruction("ADDR", bytecode); break;
+				case SUBR: printRegisterInstruction("SUBR", bytecode); break;
+				case MULR: printRegisterInstruction("MULR", bytecode); break;
+				case DIVR: printRegisterInstruction("DIVR", bytecode); break;
+				case MODR: printRegisterInstruction("MODR", bytecode); break;
+				case GRTR: printRegisterInstruction("GRTR", bytecode); break;
+				case LSTR: printRegisterInstruction("LSTR", bytecode); break;
+				case GRER: printRegisterInstruction("GRER", bytecode); break;
+				case LSER: printRegisterInstruction("LSER", bytecode); break;
+				case EQUR: printRegisterInstruction("EQUR", bytecode); break;
+				case NEQR: printRegisterInstruction("NEQR", bytecode); break;
+
 				case PRINT: printInstruction("PRINT"); break;
 				case RET: printInstruction("RET"); break;
 			}
 		}
+	}
+
+	size_t Disassembler::readOperand(const Bytecode& bytecode) {
+		if (!wide) return bytecode.blob[++ip];
+
+		wide = false;
+		ip += 4;
+		return Bytecode::readWord(&bytecode.blob[ip - 3]);
+	}
+
+	size_t Disassembler::readJump(const Bytecode& bytecode) {
+		if (wide) return readOperand(bytecode);
+
+		ip += 2;
+		return Bytecode::readShort(&bytecode.blob[ip - 1]);
+	}
+
+	// Variables show as their stack index, constants as k and their offset.
+	void Disassembler::printRegisterInstruction(const std::string& opcode, const Bytecode& bytecode) {
+		std::string operands;
+		std::string comment;
+
+		for (int i = 0; i < 2; i++) {
+			const auto operand = bytecode.blob[++ip];
+			if (!operands.empty()) operands += " ";
+
+			if (operand >= REGISTER_CONSTANT) {
+				const auto& constant = bytecode.constants[operand - REGISTER_CONSTANT];
+				operands += "k" + std::to_string(operand - REGISTER_CONSTANT);
+				comment += (comment.empty() ? "" : " ") + constant.toString();
+			} else {
+				operands += std::to_string(operand);
+			}
+		}
 
-#undef GET_CONST
+		printInstruction(opcode, operands, comment);
 	}
 
 	void Disassembler::printInstruction(const std::string& opcode,
 			const std::string& operands, const std::string& comment) {
-		printf("%5zu ", ip - 1);
+		printf("%5zu ", offset);
 		std::cout << ANSICodes::BOLD << ANSICodes::GREEN;
 		printf("%-10s", opcode.c_str());
 		std::cout << ANSICodes::RESET;
@@ -0,0 +1,447 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "Heap.h"
+
+namespace cu {
+
+	using Clock = std::chrono::steady_clock;
+
+	constexpr size_t Heap::NURSERY_SIZE;
+	constexpr size_t Heap::INITIAL_GC_THRESHOLD;
+	constexpr size_t Heap::GC_GROWTH_FACTOR;
+	constexpr size_t Heap::SLICE_INTERVAL;
+	constexpr size_t Heap::SLICE_CHECK_INTERVAL;
+	constexpr size_t Heap::TRACE_STEP;
+	constexpr size_t Heap::SLICED_STRING_RATIO;
+
+	/*
+		Shades the old-space objects referenced by the visited slots.
+		Young objects are skipped, they are marked when promoted.
+		The parents of slices are left to releaseSliceParents().
+	*/
+	class Heap::Marker : public Tracer {
+	public:
+		Marker(Heap& heap) : heap(heap) {}
+
+		void visit(Value& value) {
+			if (value.isObject() && !heap.nursery.contains(value.asObject())) {
+				heap.markObject(value.asObject());
+			}
+		}
+
+		void visitSliceParent(StringObject& slice) {
+			heap.slicedStrings.push_back(&slice);
+		}
+	private:
+		Heap& heap;
+	};
+
+	// Promotes the young objects referenced by the visited
+	// slots and points the slots to their new location.
+	class Heap::Scavenger : public Tracer {
+	public:
+		Scavenger(Heap& heap) : heap(heap) {}
+
+		void visit(Value& value) {
+			if (value.isObject() && heap.nursery.contains(value.asObject())) {
+				value = Value::object(heap.promote(value.asObject()));
+			}
+		}
+	private:
+		Heap& heap;
+	};
+
+	Heap::Heap() : nursery(NURSERY_SIZE) {
+		rootShape = allocateTenured<Shape>();
+	}
+
+	Heap::~Heap() {
+		for (Object* list : { objects, unswept }) {
+			while (list != nullptr) {
+				Object* next = list->next;
+				free(list);
+				list = next;
+			}
+		}
+	}
+
+	void Heap::track(Object* obj) {
+		obj->next = objects;
+		objects = obj;
+		bytesAllocated += obj->footprint();
+
+		// Allocate black while marking. Any object stored
+		// into this one from now on is shaded by the barrier.
+		obj->marked = phase == Phase::MARKING;
+	}
+
+	void Heap::free(Object* obj) {
+		const size_t size = obj->cellSize;
+		obj->~Object();
+		slabs.free(obj, size);
+	}
+
+	StringObject* Heap::intern(const std::string& utf8) {
+		std::string units;
+		const bool twoByte = StringObject::encode(utf8, units);
+		const StringUnits view{ units.data(), units.size() };
+		const auto hash = StringObject::hashOf(view);
+
+		StringObject* interned = strings.find(view, twoByte, hash);
+		if (interned != nullptr) return interned;
+
+		interned = allocateTenured<StringObject>(std::move(units), twoByte);
+		interned->hash = hash;
+		interned->hashed = true;
+		interned->markInterned();
+		strings.insert(interned);
+
+		return interned;
+	}
+
+	StringObject* Heap::intern(const StringObject& str) {
+		StringObject* interned = findInterned(str);
+		if (interned != nullptr) return interned;
+
+		interned = allocateTenured<StringObject>(str.units().str(), str.isTwoByte());
+		interned->hash = str.hashCode();
+		interned->hashed = true;
+		interned->markInterned();
+		strings.insert(interned);
+
+		return interned;
+	}
+
+	StringObject* Heap::findInterned(const std::string& utf8) const {
+		std::string units;
+		const bool twoByte = StringObject::encode(utf8, units);
+		const StringUnits view{ units.data(), units.size() };
+		return strings.find(view, twoByte, StringObject::hashOf(view));
+	}
+
+	StringObject* Heap::findInterned(const StringObject& str) const {
+		if (str.isInterned()) return const_cast<StringObject*>(&str);
+		return strings.find(str.units(), str.isTwoByte(), str.hashCode());
+	}
+
+	Shape* Heap::addProperty(Shape* shape, StringObject* key) {
+		auto& child = transitions[{ shape, key }];
+		if (child == nullptr) {
+			child = allocateTenured<Shape>(shape, key);
+
+			// The new shape is black, but its parent
+			// and key still need to be traced.
+			if (phase == Phase::MARKING) grayStack.push_back(child);
+		}
+
+		return child;
+	}
+
+	void Heap::remember(Object* obj) {
+		obj->remembered = true;
+		rememberedSet.push_back(obj);
+	}
+
+	void Heap::setMaxPause(const std::chrono::microseconds pause) {
+		incremental = true;
+		maxPause = pause;
+	}
+
+	void Heap::collect(const RootTracer& traceRoots) {
+		const auto start = Clock::now();
+		const auto deadline = incremental ? start + maxPause : Clock::time_point::max();
+
+		allocationsSinceSlice = 0;
+
+#ifdef DEBUG_STRESS_GC
+		const bool stress = true;
+#else
+		const bool stress = false;
+#endif
+
+		if (nursery.isExhausted() || stress) {
+			scavenge(traceRoots);
+		}
+
+		switch (phase) {
+			case Phase::IDLE:
+				if (bytesAllocated <= nextGC && !stress) break;
+
+				startMarking(traceRoots);
+				if (incremental) break;
+
+				// Stop-the-world collections run the whole cycle at once.
+				markSlice(deadline);
+				finishMarking(traceRoots);
+				sweepSlice(deadline);
+				break;
+
+			case Phase::MARKING:
+				/*
+					If the program allocates faster than we can mark, give up
+					on the pause bound rather than letting the heap grow
+					without bounds.
+				*/
+				if (bytesAllocated > nextGC * GC_GROWTH_FACTOR) {
+					markSlice(Clock::time_point::max());
+					finishMarking(traceRoots);
+					sweepSlice(Clock::time_point::max());
+				} else if (markSlice(deadline)) {
+					finishMarking(traceRoots);
+				}
+				break;
+
+			case Phase::SWEEPING:
+				sweepSlice(deadline);
+				break;
+		}
+
+		const auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+		stats.slices++;
+		stats.totalPause += pause;
+		stats.maxPause = std::max(stats.maxPause, pause);
+	}
+
+	/*
+		Minor collection
+
+		The roots of the young generation are the VM's roots plus the
+		written parts of every old object in the remembered set. Survivors
+		are moved into the old space and their references are traced in
+		turn.
+	*/
+	void Heap::scavenge(const RootTracer& traceRoots) {
+#ifdef DEBUG_LOG_GC
+		auto nurseryUsed = nursery.used();
+		auto oldBefore = bytesAllocated;
+#endif
+
+		Scavenger scavenger(*this);
+		traceRoots(scavenger);
+
+		for (Object* obj : rememberedSet) {
+			obj->remembered = false;
+			obj->traceRemembered(scavenger);
+		}
+
+		rememberedSet.clear();
+
+		while (!promotedStack.empty()) {
+			Object* obj = promotedStack.back();
+			promotedStack.pop_back();
+			obj->trace(scavenger);
+		}
+
+		nursery.reset();
+		stats.minorCollections++;
+
+#ifdef DEBUG_LOG_GC
+		std::cout << "gc (minor): scanned " << nurseryUsed << " nursery bytes, promoted ";
+		std::cout << bytesAllocated - oldBefore << " bytes" << std::endl;
+#endif
+	}
+
+	Object* Heap::promote(Object* obj) {
+		auto cell = Nursery::cellOf(obj);
+		if (cell->forwarded != nullptr) return cell->forwarded;
+
+		Object* copy = obj->relocate(slabs.allocate(cell->size));
+		obj->~Object();
+
+		copy->cellSize = static_cast<uint16_t>(cell->size);
+		copy->remembered = false;
+		cell->forwarded = copy;
+		track(copy);
+		promotedStack.push_back(copy);
+
+		// The copy is black, but its old-space children still
+		// need to be traced by the marker.
+		if (phase == Phase::MARKING) grayStack.push_back(copy);
+
+		return copy;
+	}
+
+	/*
+		Major collection
+
+		Marking starts by shading the roots and then traces gray objects in
+		slices. Once there are none left, the roots are traced once more
+		since stores into them are not fully covered by the barrier. Sweeping
+		then frees the objects that are still white, again in slices.
+	*/
+	void Heap::startMarking(const RootTracer& traceRoots) {
+		phase = Phase::MARKING;
+
+		Marker marker(*this);
+		traceRoots(marker);
+		markObject(rootShape);
+	}
+
+	/*
+		Large objects are traced TRACE_STEP Values at a time, so that a
+		slice can end in the middle of one. The next slice resumes it.
+		Values stored into the part already traced are shaded by the
+		barrier, since the object is marked.
+	*/
+	bool Heap::markSlice(const Clock::time_point deadline) {
+		Marker marker(*this);
+		size_t traced = 0;
+
+		while (tracing != nullptr || !grayStack.empty()) {
+			if (tracing == nullptr) {
+				tracing = grayStack.back();
+				grayStack.pop_back();
+				cursor = TraceCursor();
+			}
+
+			if (!tracing->traceSome(marker, cursor, TRACE_STEP)) {
+				if (Clock::now() >= deadline) return false;
+				continue;
+			}
+
+			tracing = nullptr;
+
+			if (++traced % SLICE_CHECK_INTERVAL == 0 && Clock::now() >= deadline) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Heap::finishMarking(const RootTracer& traceRoots) {
+		// Promote everything that is still live in the nursery so
+		// that the whole live set is in the old space and marked.
+		scavenge(traceRoots);
+
+		Marker marker(*this);
+		traceRoots(marker);
+		markObject(rootShape);
+		markSlice(Clock::time_point::max());
+
+		releaseSliceParents();
+		startSweeping();
+	}
+
+	/*
+		A slice keeps its whole parent alive. Once marking is done, the
+		parents that are not otherwise reachable are known. Rather than
+		retaining such a parent for the sake of a small part of it, the
+		slice is given its own copy of its characters.
+	*/
+	void Heap::releaseSliceParents() {
+		for (StringObject* slice : slicedStrings) {
+			if (!slice->isSlice()) continue;
+
+			StringObject* parent = slice->first.asString();
+			if (parent->marked) continue;
+
+			if (slice->length() * SLICED_STRING_RATIO < parent->length()) {
+				slice->copyOut();
+			} else {
+				// Parents are flat, so there is nothing to trace.
+				parent->marked = true;
+			}
+		}
+
+		slicedStrings.clear();
+	}
+
+	void Heap::markObject(Object* obj) {
+		if (obj->marked) return;
+
+		obj->marked = true;
+		grayStack.push_back(obj);
+	}
+
+	/*
+		Objects allocated from here on go to a fresh list and are never
+		looked at by this sweep. Survivors are moved back onto it.
+	*/
+	void Heap::startSweeping() {
+		phase = Phase::SWEEPING;
+
+		// Drop the interned strings that are about to be freed, so that
+		// intern() cannot hand them out while they wait to be swept.
+		strings.removeIf([](const StringObject* str) { return !str->marked; });
+
+		// Likewise for the shapes that objects can no longer move to.
+		for (auto itr = transitions.begin(); itr != transitions.end();) {
+			itr = itr->second->marked ? std::next(itr) : transitions.erase(itr);
+		}
+
+		unswept = objects;
+		objects = nullptr;
+
+#ifdef DEBUG_LOG_GC
+		std::cout << "gc (major): sweeping " << bytesAllocated << " bytes" << std::endl;
+#endif
+
+		bytesAllocated = 0;
+	}
+
+	bool Heap::sweepSlice(const Clock::time_point deadline) {
+		size_t swept = 0;
+
+		while (unswept != nullptr) {
+			Object* obj = unswept;
+			unswept = obj->next;
+
+			if (obj->marked) {
+				obj->marked = false;
+				obj->next = objects;
+				objects = obj;
+				bytesAllocated += obj->footprint();
+			} else {
+				free(obj);
+			}
+
+			if (++swept % SLICE_CHECK_INTERVAL == 0 && Clock::now() >= deadline) {
+				return false;
+			}
+		}
+
+		finishCycle();
+		return true;
+	}
+
+	void Heap::finishCycle() {
+		phase = Phase::IDLE;
+		nextGC = std::max(bytesAllocated * GC_GROWTH_FACTOR, INITIAL_GC_THRESHOLD);
+		stats.majorCollections++;
+
+#ifdef DEBUG_LOG_GC
+		std::cout << "gc (major): " << bytesAllocated << " bytes live, next at " << nextGC << std::endl;
+#endif
+	}
+
+	void Heap::printStats(std::ostream& stream) const {
+		using Millis = std::chrono::duration<double, std::milli>;
+
+		stream << "gc: " << stats.minorCollections << " minor, " << stats.majorCollections;
+		stream << " major collections in " << stats.slices << " pauses" << std::endl;
+		stream << "gc: max pause " << Millis(stats.maxPause).count() << " ms, total ";
+		stream << Millis(stats.totalPause).count() << " ms" << std::endl;
+
+		stream << "heap: nursery " << nursery.used() << " of " << NURSERY_SIZE << " bytes in use" << std::endl;
+		stream << "heap: " << strings.size() << " interned strings" << std::endl;
+		slabs.printStats(stream);
+	}
+
+} // namespace cu
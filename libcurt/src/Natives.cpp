@@ -0,0 +1,801 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include "Natives.h"
+#include "NumberKernels.h"
+
+namespace cu {
+
+	/*
+		Converts a position argument to an index in [0, length]. Relative
+		positions count back from the end, as they do for slice(). Returns
+		false if the argument is not a number.
+	*/
+	static bool toIndex(const Value& position, const size_t length, const size_t fallback,
+			const bool relative, size_t& index) {
+		if (position.isUndefined()) {
+			index = fallback;
+			return true;
+		}
+
+		if (!position.isNumber()) return false;
+
+		double integer = std::trunc(position.asNumber());
+		if (integer != integer) integer = 0;
+		if (integer < 0) integer = relative ? std::max(0.0, length + integer) : 0;
+
+		index = static_cast<size_t>(std::min(integer, static_cast<double>(length)));
+		return true;
+	}
+
+	// str.slice(start, end)
+	static bool stringSlice(const NativeCall& call, Value& result, std::string& error) {
+		const auto length = call.receiver.asString()->length();
+
+		size_t start, end;
+		if (!toIndex(call.arg(0), length, 0, true, start) || !toIndex(call.arg(1), length, length, true, end)) {
+			error = "slice() expects numeric arguments";
+			return false;
+		}
+
+		result = StringObject::slice(call.heap, call.receiver, start, std::max(start, end));
+		return true;
+	}
+
+	// str.indexOf(search, fromIndex)
+	static bool stringIndexOf(const NativeCall& call, Value& result, std::string& error) {
+		const auto str = call.receiver.asString();
+		if (!call.arg(0).isString()) {
+			error = "indexOf() expects a string";
+			return false;
+		}
+
+		size_t from;
+		if (!toIndex(call.arg(1), str->length(), 0, false, from)) {
+			error = "indexOf() expects a numeric position";
+			return false;
+		}
+
+		const auto search = call.arg(0).asString();
+		result = Value::number(-1);
+
+		// A one-byte string cannot contain a unit above 0xFF.
+		if (search->isTwoByte() && !str->isTwoByte()) return true;
+		if (search->length() > str->length()) return true;
+
+		const auto last = str->length() - search->length();
+
+		if (search->isTwoByte() == str->isTwoByte()) {
+			const auto haystack = str->units();
+			const auto needle = search->units();
+			const size_t width = str->isTwoByte() ? 2 : 1;
+
+			for (size_t i = from; i <= last; i++) {
+				if (std::memcmp(haystack.data + i * width, needle.data, needle.size) == 0) {
+					result = Value::number(i);
+					return true;
+				}
+			}
+
+			return true;
+		}
+
+		for (size_t i = from; i <= last; i++) {
+			size_t matched = 0;
+			while (matched < search->length() && str->unitAt(i + matched) == search->unitAt(matched)) {
+				matched++;
+			}
+
+			if (matched == search->length()) {
+				result = Value::number(i);
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+	/*
+		Copies the keys or values of a table into a new array. There are
+		no iterators, so keys(), values() and entries() return arrays.
+	*/
+	static Value tableToArray(Heap& heap, const ValueTable& table, const bool keys) {
+		auto arr = heap.allocate<ArrayObject>();
+
+		for (const auto& entry : table.getEntries()) {
+			if (entry.removed) continue;
+
+			const auto& element = keys ? entry.key : entry.value;
+			arr->push(element);
+			heap.writeBarrier(arr, arr->length() - 1, element);
+		}
+
+		return Value::object(arr);
+	}
+
+	// map.get(key)
+	static bool mapGet(const NativeCall& call, Value& result, std::string&) {
+		const auto value = call.receiver.asMap()->get(call.arg(0));
+		result = value != nullptr ? *value : Value::undefined();
+		return true;
+	}
+
+	// map.set(key, value)
+	static bool mapSet(const NativeCall& call, Value& result, std::string&) {
+		call.receiver.asMap()->set(call.arg(0), call.arg(1), call.heap);
+		result = call.receiver;
+		return true;
+	}
+
+	// map.has(key)
+	static bool mapHas(const NativeCall& call, Value& result, std::string&) {
+		result = Value::boolean(call.receiver.asMap()->get(call.arg(0)) != nullptr);
+		return true;
+	}
+
+	// map.delete(key)
+	static bool mapDelete(const NativeCall& call, Value& result, std::string&) {
+		result = Value::boolean(call.receiver.asMap()->remove(call.arg(0)));
+		return true;
+	}
+
+	// map.clear()
+	static bool mapClear(const NativeCall& call, Value& result, std::string&) {
+		call.receiver.asMap()->clear();
+		result = Value::undefined();
+		return true;
+	}
+
+	// map.keys()
+	static bool mapKeys(const NativeCall& call, Value& result, std::string&) {
+		result = tableToArray(call.heap, call.receiver.asMap()->getTable(), true);
+		return true;
+	}
+
+	// map.values()
+	static bool mapValues(const NativeCall& call, Value& result, std::string&) {
+		result = tableToArray(call.heap, call.receiver.asMap()->getTable(), false);
+		return true;
+	}
+
+	// map.entries()
+	static bool mapEntries(const NativeCall& call, Value& result, std::string&) {
+		auto& heap = call.heap;
+		auto entries = heap.allocate<ArrayObject>();
+
+		// Each pair is reachable from entries as soon as it is
+		// pushed, and nothing is collected until INVOKE returns.
+		for (const auto& entry : call.receiver.asMap()->getTable().getEntries()) {
+			if (entry.removed) continue;
+
+			auto pair = heap.allocate<ArrayObject>();
+			pair->push(entry.key);
+			heap.writeBarrier(pair, 0, entry.key);
+			pair->push(entry.value);
+			heap.writeBarrier(pair, 1, entry.value);
+
+			entries->push(Value::object(pair));
+			heap.writeBarrier(entries, entries->length() - 1, Value::object(pair));
+		}
+
+		result = Value::object(entries);
+		return true;
+	}
+
+	// set.add(value)
+	static bool setAdd(const NativeCall& call, Value& result, std::string&) {
+		call.receiver.asSet()->add(call.arg(0), call.heap);
+		result = call.receiver;
+		return true;
+	}
+
+	// set.has(value)
+	static bool setHas(const NativeCall& call, Value& result, std::string&) {
+		result = Value::boolean(call.receiver.asSet()->has(call.arg(0)));
+		return true;
+	}
+
+	// set.delete(value)
+	static bool setDelete(const NativeCall& call, Value& result, std::string&) {
+		result = Value::boolean(call.receiver.asSet()->remove(call.arg(0)));
+		return true;
+	}
+
+	// set.clear()
+	static bool setClear(const NativeCall& call, Value& result, std::string&) {
+		call.receiver.asSet()->clear();
+		result = Value::undefined();
+		return true;
+	}
+
+	// set.values()
+	static bool setValues(const NativeCall& call, Value& result, std::string&) {
+		result = tableToArray(call.heap, call.receiver.asSet()->getTable(), true);
+		return true;
+	}
+
+	/*
+		The elements of a dense array, as doubles. Only meaningful for
+		packed arrays, except to NumberKernels::find(), see there.
+	*/
+	static const double* numbers(const ArrayObject::ElementView& elements) {
+		static_assert(sizeof(Value) == sizeof(double), "a Value must be as wide as a double");
+		return reinterpret_cast<const double*>(elements.data);
+	}
+
+	static Value foundAt(const size_t index) {
+		return Value::number(index == NumberKernels::NOT_FOUND ? -1 : static_cast<double>(index));
+	}
+
+	// arr.push(...items)
+	static bool arrayPush(const NativeCall& call, Value& result, std::string&) {
+		const auto arr = call.receiver.asArray();
+
+		for (size_t i = 0; i < call.argCount; i++) {
+			arr->push(call.args[i]);
+			call.heap.writeBarrier(arr, arr->length() - 1, call.args[i]);
+		}
+
+		result = Value::number(arr->length());
+		return true;
+	}
+
+	// arr.pop()
+	static bool arrayPop(const NativeCall& call, Value& result, std::string&) {
+		result = call.receiver.asArray()->pop();
+		return true;
+	}
+
+	// arr.slice(start, end)
+	static bool arraySlice(const NativeCall& call, Value& result, std::string& error) {
+		const auto arr = call.receiver.asArray();
+		const auto length = arr->length();
+
+		size_t start, end;
+		if (!toIndex(call.arg(0), length, 0, true, start) || !toIndex(call.arg(1), length, length, true, end)) {
+			error = "slice() expects numeric arguments";
+			return false;
+		}
+
+		auto& heap = call.heap;
+		auto copy = heap.allocate<ArrayObject>();
+
+		if (arr->isSparse()) {
+			// Holes are not copied, not even trailing ones.
+			for (const auto index : arr->sparseIndices()) {
+				if (index < start || index >= end) continue;
+
+				const auto element = (*arr)[index];
+				copy->set(Value::number(index - start), element, heap);
+			}
+		} else {
+			const auto elements = arr->elements();
+			for (size_t i = start; i < end; i++) {
+				copy->push(elements[i]);
+				heap.writeBarrier(copy, i - start, elements[i]);
+			}
+		}
+
+		result = Value::object(copy);
+		return true;
+	}
+
+	// arr.indexOf(search, fromIndex)
+	static bool arrayIndexOf(const NativeCall& call, Value& result, std::string& error) {
+		const auto arr = call.receiver.asArray();
+		const auto search = call.arg(0);
+
+		size_t from;
+		if (!toIndex(call.arg(1), arr->length(), 0, true, from)) {
+			error = "indexOf() expects a numeric position";
+			return false;
+		}
+
+		result = Value::number(-1);
+
+		if (arr->isSparse()) {
+			for (const auto index : arr->sparseIndices()) {
+				if (index >= from && (*arr)[index].strictEquals(search)) {
+					result = Value::number(index);
+					return true;
+				}
+			}
+
+			return true;
+		}
+
+		const auto elements = arr->elements();
+		if (search.isNumber()) {
+			result = foundAt(NumberKernels::find(numbers(elements), elements.size, from, search.asNumber()));
+			return true;
+		}
+
+		if (arr->isPacked()) return true;
+
+		for (size_t i = from; i < elements.size; i++) {
+			if (elements[i].strictEquals(search)) {
+				result = Value::number(i);
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+	// arr.includes(search, fromIndex)
+	static bool arrayIncludes(const NativeCall& call, Value& result, std::string& error) {
+		const auto arr = call.receiver.asArray();
+		const auto search = call.arg(0);
+
+		size_t from;
+		if (!toIndex(call.arg(1), arr->length(), 0, true, from)) {
+			error = "includes() expects a numeric position";
+			return false;
+		}
+
+		result = Value::boolean(false);
+
+		if (arr->isSparse()) {
+			// Holes are undefined, and a sparse array always has some.
+			if (search.isUndefined()) {
+				result = Value::boolean(from < arr->length());
+				return true;
+			}
+
+			for (const auto index : arr->sparseIndices()) {
+				if (index >= from && (*arr)[index].sameValueZero(search)) {
+					result = Value::boolean(true);
+					return true;
+				}
+			}
+
+			return true;
+		}
+
+		const auto elements = arr->elements();
+		const auto number = search.isNumber() ? search.asNumber() : 0;
+
+		// Tagged values are NaNs too, so only a packed array can be
+		// searched for NaN by its bits.
+		if (search.isNumber() && (number == number || arr->isPacked())) {
+			const auto index = number == number ?
+				NumberKernels::find(numbers(elements), elements.size, from, number) :
+				NumberKernels::findNaN(numbers(elements), elements.size, from);
+
+			result = Value::boolean(index != NumberKernels::NOT_FOUND);
+			return true;
+		}
+
+		if (arr->isPacked()) return true;
+
+		for (size_t i = from; i < elements.size; i++) {
+			if (elements[i].sameValueZero(search)) {
+				result = Value::boolean(true);
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+	// arr.fill(value, start, end)
+	static bool arrayFill(const NativeCall& call, Value& result, std::string& error) {
+		const auto arr = call.receiver.asArray();
+		const auto length = arr->length();
+
+		size_t start, end;
+		if (!toIndex(call.arg(1), length, 0, true, start) || !toIndex(call.arg(2), length, length, true, end)) {
+			error = "fill() expects numeric positions";
+			return false;
+		}
+
+		if (start < end) {
+			arr->fill(call.arg(0), start, end);
+			call.heap.writeBarrier(arr, start, end, call.arg(0));
+		}
+
+		result = call.receiver;
+		return true;
+	}
+
+	/*
+		Finds the elements of an array for sum(), min() and max(), which
+		only take arrays of numbers. A sparse array always has holes.
+	*/
+	static bool numericElements(const ArrayObject& arr, const char* method, ArrayObject::ElementView& elements,
+			std::string& error) {
+		elements = arr.elements();
+
+		bool numeric = !arr.isSparse();
+		if (numeric && !arr.isPacked()) {
+			numeric = std::all_of(elements.begin(), elements.end(), [](const Value& element) {
+				return element.isNumber();
+			});
+		}
+
+		if (!numeric) error = std::string(method) + "() expects an array of numbers";
+		return numeric;
+	}
+
+	// arr.sum(), which is not in JavaScript.
+	static bool arraySum(const NativeCall& call, Value& result, std::string& error) {
+		ArrayObject::ElementView elements;
+		if (!numericElements(*call.receiver.asArray(), "sum", elements, error)) return false;
+
+		result = Value::number(NumberKernels::sum(numbers(elements), elements.size));
+		return true;
+	}
+
+	// arr.min(), like Math.min(...arr)
+	static bool arrayMin(const NativeCall& call, Value& result, std::string& error) {
+		ArrayObject::ElementView elements;
+		if (!numericElements(*call.receiver.asArray(), "min", elements, error)) return false;
+
+		result = Value::number(NumberKernels::min(numbers(elements), elements.size));
+		return true;
+	}
+
+	// arr.max(), like Math.max(...arr)
+	static bool arrayMax(const NativeCall& call, Value& result, std::string& error) {
+		ArrayObject::ElementView elements;
+		if (!numericElements(*call.receiver.asArray(), "max", elements, error)) return false;
+
+		result = Value::number(NumberKernels::max(numbers(elements), elements.size));
+		return true;
+	}
+
+	/*
+		Typed arrays have the same methods, except push(), pop() and
+		slice(). Float64Arrays go through NumberKernels, the integer
+		types, which have neither NaN nor -0, through plain loops.
+	*/
+	static const double* float64Data(const TypedArrayObject& typed) {
+		return reinterpret_cast<const double*>(typed.data());
+	}
+
+	static bool isFloat64(const TypedArrayObject& typed) {
+		return typed.getElementType() == TypedArrayObject::ElementType::FLOAT64;
+	}
+
+	// typed.indexOf(search, fromIndex)
+	static bool typedIndexOf(const NativeCall& call, Value& result, std::string& error) {
+		const auto typed = call.receiver.asTypedArray();
+		const auto search = call.arg(0);
+
+		size_t from;
+		if (!toIndex(call.arg(1), typed->length(), 0, true, from)) {
+			error = "indexOf() expects a numeric position";
+			return false;
+		}
+
+		result = Value::number(-1);
+		if (!search.isNumber()) return true;
+
+		if (isFloat64(*typed)) {
+			result = foundAt(NumberKernels::find(float64Data(*typed), typed->length(), from, search.asNumber()));
+			return true;
+		}
+
+		for (size_t i = from; i < typed->length(); i++) {
+			if (typed->getElement(i).asNumber() == search.asNumber()) {
+				result = Value::number(i);
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+	// typed.includes(search, fromIndex)
+	static bool typedIncludes(const NativeCall& call, Value& result, std::string& error) {
+		const auto typed = call.receiver.asTypedArray();
+		const auto search = call.arg(0);
+
+		size_t from;
+		if (!toIndex(call.arg(1), typed->length(), 0, true, from)) {
+			error = "includes() expects a numeric position";
+			return false;
+		}
+
+		result = Value::boolean(false);
+		if (!search.isNumber()) return true;
+
+		const auto number = search.asNumber();
+		if (isFloat64(*typed)) {
+			const auto index = number == number ?
+				NumberKernels::find(float64Data(*typed), typed->length(), from, number) :
+				NumberKernels::findNaN(float64Data(*typed), typed->length(), from);
+
+			result = Value::boolean(index != NumberKernels::NOT_FOUND);
+			return true;
+		}
+
+		for (size_t i = from; i < typed->length(); i++) {
+			if (typed->getElement(i).asNumber() == number) {
+				result = Value::boolean(true);
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+	// typed.fill(value, start, end)
+	static bool typedFill(const NativeCall& call, Value& result, std::string& error) {
+		const auto typed = call.receiver.asTypedArray();
+
+		size_t start, end;
+		if (!toIndex(call.arg(1), typed->length(), 0, true, start) ||
+				!toIndex(call.arg(2), typed->length(), typed->length(), true, end)) {
+			error = "fill() expects numeric positions";
+			return false;
+		}
+
+		const auto number = TypedArrayObject::toNumber(call.arg(0));
+		for (size_t i = start; i < end; i++) {
+			typed->setElement(i, number);
+		}
+
+		result = call.receiver;
+		return true;
+	}
+
+	// typed.sum()
+	static bool typedSum(const NativeCall& call, Value& result, std::string&) {
+		const auto typed = call.receiver.asTypedArray();
+
+		if (isFloat64(*typed)) {
+			result = Value::number(NumberKernels::sum(float64Data(*typed), typed->length()));
+			return true;
+		}
+
+		double sum = 0;
+		for (size_t i = 0; i < typed->length(); i++) {
+			sum += typed->getElement(i).asNumber();
+		}
+
+		result = Value::number(sum);
+		return true;
+	}
+
+	// typed.min()
+	static bool typedMin(const NativeCall& call, Value& result, std::string&) {
+		const auto typed = call.receiver.asTypedArray();
+
+		if (isFloat64(*typed)) {
+			result = Value::number(NumberKernels::min(float64Data(*typed), typed->length()));
+			return true;
+		}
+
+		double min = INFINITY;
+		for (size_t i = 0; i < typed->length(); i++) {
+			min = std::min(min, typed->getElement(i).asNumber());
+		}
+
+		result = Value::number(min);
+		return true;
+	}
+
+	// typed.max()
+	static bool typedMax(const NativeCall& call, Value& result, std::string&) {
+		const auto typed = call.receiver.asTypedArray();
+
+		if (isFloat64(*typed)) {
+			result = Value::number(NumberKernels::max(float64Data(*typed), typed->length()));
+			return true;
+		}
+
+		double max = -INFINITY;
+		for (size_t i = 0; i < typed->length(); i++) {
+			max = std::max(max, typed->getElement(i).asNumber());
+		}
+
+		result = Value::number(max);
+		return true;
+	}
+
+	NativeMethod findMethod(const Value& receiver, const StringObject& name) {
+		typedef std::unordered_map<std::string, NativeMethod> MethodTable;
+
+		static const MethodTable stringMethods = {
+			{ "indexOf", stringIndexOf },
+			{ "slice", stringSlice },
+		};
+
+		static const MethodTable arrayMethods = {
+			{ "fill", arrayFill },
+			{ "includes", arrayIncludes },
+			{ "indexOf", arrayIndexOf },
+			{ "max", arrayMax },
+			{ "min", arrayMin },
+			{ "pop", arrayPop },
+			{ "push", arrayPush },
+			{ "slice", arraySlice },
+			{ "sum", arraySum },
+		};
+
+		static const MethodTable typedArrayMethods = {
+			{ "fill", typedFill },
+			{ "includes", typedIncludes },
+			{ "indexOf", typedIndexOf },
+			{ "max", typedMax },
+			{ "min", typedMin },
+			{ "sum", typedSum },
+		};
+
+		static const MethodTable mapMethods = {
+			{ "clear", mapClear },
+			{ "delete", mapDelete },
+			{ "entries", mapEntries },
+			{ "get", mapGet },
+			{ "has", mapHas },
+			{ "keys", mapKeys },
+			{ "set", mapSet },
+			{ "values", mapValues },
+		};
+
+		static const MethodTable setMethods = {
+			{ "add", setAdd },
+			{ "clear", setClear },
+			{ "delete", setDelete },
+			{ "has", setHas },
+			{ "values", setValues },
+		};
+
+		const MethodTable* methods;
+		switch (receiver.type()) {
+			case ObjectType::STRING: methods = &stringMethods; break;
+			case ObjectType::ARRAY: methods = &arrayMethods; break;
+			case ObjectType::TYPED_ARRAY: methods = &typedArrayMethods; break;
+			case ObjectType::MAP: methods = &mapMethods; break;
+			case ObjectType::SET: methods = &setMethods; break;
+			default: return nullptr;
+		}
+
+		const auto itr = methods->find(name.toString());
+		return itr != methods->end() ? itr->second : nullptr;
+	}
+
+	bool fillMap(Heap& heap, MapObject& map, const Value& entries, std::string& error) {
+		if (!entries.isArray()) {
+			error = "Map expects an array of [key, value] entries";
+			return false;
+		}
+
+		const auto arr = entries.asArray();
+		for (size_t i = 0; i < arr->length(); i++) {
+			const auto entry = (*arr)[i];
+			if (!entry.isArray()) {
+				error = "Map entry is not an array: " + entry.toString();
+				return false;
+			}
+
+			map.set((*entry.asArray())[0], (*entry.asArray())[1], heap);
+		}
+
+		return true;
+	}
+
+	bool fillSet(Heap& heap, SetObject& set, const Value& values, std::string& error) {
+		if (!values.isArray()) {
+			error = "Set expects an array of values";
+			return false;
+		}
+
+		const auto arr = values.asArray();
+		for (size_t i = 0; i < arr->length(); i++) {
+			set.add((*arr)[i], heap);
+		}
+
+		return true;
+	}
+
+	Value stringProperty(Heap& heap, const Value& value, const Value& property) {
+		const auto str = value.asString();
+
+		if (property.isNumber()) {
+			const auto index = property.asNumber();
+			if (index >= 0 && index < str->length() && index == std::trunc(index)) {
+				return StringObject::slice(heap, value, index, index + 1);
+			}
+		} else if (property.isString()) {
+			static const StringUnits LENGTH{ "length", 6 };
+
+			const auto name = property.asString();
+			if (!name->isTwoByte() && name->units() == LENGTH) {
+				return Value::number(str->length());
+			}
+		}
+
+		return Value::undefined();
+	}
+
+	bool newTypedArray(Heap& heap, const TypedArrayObject::ElementType elementType, const Value& source,
+			Value& result, std::string& error) {
+		const auto elementSize = TypedArrayObject::elementSize(elementType);
+
+		if (source.isString()) {
+			RawBuffer buffer;
+			if (!RawBuffer::map(source.asString()->toString(), buffer, error)) return false;
+
+			result = Value::object(heap.allocate<TypedArrayObject>(elementType, std::move(buffer)));
+			return true;
+		}
+
+		if (source.isNumber()) {
+			const auto length = source.asNumber();
+			if (!(length >= 0 && length <= UINT32_MAX) || length != std::trunc(length)) {
+				error = "Invalid typed array length: " + source.toString();
+				return false;
+			}
+
+			const auto size = static_cast<size_t>(length) * elementSize;
+			result = Value::object(heap.allocate<TypedArrayObject>(elementType, RawBuffer::allocate(size)));
+			return true;
+		}
+
+		if (source.isArray()) {
+			const auto arr = source.asArray();
+			const auto typed = heap.allocate<TypedArrayObject>(elementType, RawBuffer::allocate(arr->length() * elementSize));
+
+			for (size_t i = 0; i < arr->length(); i++) {
+				typed->set(Value::number(i), (*arr)[i], heap);
+			}
+
+			result = Value::object(typed);
+			return true;
+		}
+
+		if (source.isTypedArray()) {
+			const auto other = source.asTypedArray();
+			const auto typed = heap.allocate<TypedArrayObject>(elementType, RawBuffer::allocate(other->length() * elementSize));
+
+			if (other->getElementType() == elementType) {
+				std::memcpy(typed->data(), other->data(), other->length() * elementSize);
+			} else {
+				for (size_t i = 0; i < other->length(); i++) {
+					typed->setElement(i, other->getElement(i).asNumber());
+				}
+			}
+
+			result = Value::object(typed);
+			return true;
+		}
+
+		error = std::string(TypedArrayObject::name(elementType)) + " expects a length, an array or a file path";
+		return false;
+	}
+
+	Value collectionProperty(const Value& collection, const Value& property) {
+		static const StringUnits SIZE{ "size", 4 };
+
+		if (property.isString()) {
+			const auto name = property.asString();
+			if (!name->isTwoByte() && name->units() == SIZE) {
+				const auto size = collection.isMap() ? collection.asMap()->size() : collection.asSet()->size();
+				return Value::number(size);
+			}
+		}
+
+		return Value::undefined();
+	}
+
+} // namespace cu
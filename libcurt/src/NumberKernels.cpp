@@ -0,0 +1,188 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "NumberKernels.h"
+
+namespace cu {
+
+	constexpr size_t NumberKernels::NOT_FOUND;
+
+	// The data may be the elements of an array of Values, which are not
+	// doubles as far as the compiler is concerned, so copy each one out.
+	static inline double load(const double* data, const size_t index) {
+		double number;
+		std::memcpy(&number, data + index, sizeof(double));
+		return number;
+	}
+
+	size_t NumberKernels::find(const double* data, const size_t size, const size_t from, const double number) {
+		size_t i = from;
+
+#if defined(__SSE2__)
+		const auto needle = _mm_set1_pd(number);
+		for (; i + 4 <= size; i += 4) {
+			const auto low = _mm_cmpeq_pd(_mm_loadu_pd(data + i), needle);
+			const auto high = _mm_cmpeq_pd(_mm_loadu_pd(data + i + 2), needle);
+
+			const auto matches = _mm_movemask_pd(low) | (_mm_movemask_pd(high) << 2);
+			if (matches != 0) return i + __builtin_ctz(matches);
+		}
+#endif
+
+		for (; i < size; i++) {
+			if (load(data, i) == number) return i;
+		}
+
+		return NOT_FOUND;
+	}
+
+	size_t NumberKernels::findNaN(const double* data, const size_t size, const size_t from) {
+		size_t i = from;
+
+#if defined(__SSE2__)
+		for (; i + 4 <= size; i += 4) {
+			const auto low = _mm_loadu_pd(data + i), high = _mm_loadu_pd(data + i + 2);
+
+			const auto matches = _mm_movemask_pd(_mm_cmpunord_pd(low, low)) |
+				(_mm_movemask_pd(_mm_cmpunord_pd(high, high)) << 2);
+			if (matches != 0) return i + __builtin_ctz(matches);
+		}
+#endif
+
+		for (; i < size; i++) {
+			const auto number = load(data, i);
+			if (number != number) return i;
+		}
+
+		return NOT_FOUND;
+	}
+
+	double NumberKernels::sum(const double* data, const size_t size) {
+		double result = 0;
+		size_t i = 0;
+
+#if defined(__SSE2__)
+		auto low = _mm_setzero_pd(), high = _mm_setzero_pd();
+		for (; i + 4 <= size; i += 4) {
+			low = _mm_add_pd(low, _mm_loadu_pd(data + i));
+			high = _mm_add_pd(high, _mm_loadu_pd(data + i + 2));
+		}
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_add_pd(low, high));
+		result = lanes[0] + lanes[1];
+#endif
+
+		for (; i < size; i++) {
+			result += load(data, i);
+		}
+
+		return result;
+	}
+
+	/*
+		minpd and maxpd neither propagate NaN nor order -0 and 0, so the
+		vector loops only track whether they saw a NaN, and a zero result
+		is checked for its sign afterwards.
+	*/
+	double NumberKernels::min(const double* data, const size_t size) {
+		double result = INFINITY;
+		bool unordered = false;
+		size_t i = 0;
+
+#if defined(__SSE2__)
+		auto low = _mm_set1_pd(INFINITY), high = _mm_set1_pd(INFINITY), nans = _mm_setzero_pd();
+		for (; i + 4 <= size; i += 4) {
+			const auto first = _mm_loadu_pd(data + i), second = _mm_loadu_pd(data + i + 2);
+			nans = _mm_or_pd(nans, _mm_cmpunord_pd(first, second));
+			low = _mm_min_pd(low, first);
+			high = _mm_min_pd(high, second);
+		}
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_min_pd(low, high));
+		result = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+		unordered = _mm_movemask_pd(nans) != 0;
+#endif
+
+		for (; i < size; i++) {
+			const auto number = load(data, i);
+			if (number != number) unordered = true;
+			else if (number < result) result = number;
+		}
+
+		if (unordered) return NAN;
+
+		if (result == 0) {
+			for (size_t j = 0; j < size; j++) {
+				const auto number = load(data, j);
+				if (number == 0 && std::signbit(number)) return -0.0;
+			}
+
+			return 0;
+		}
+
+		return result;
+	}
+
+	double NumberKernels::max(const double* data, const size_t size) {
+		double result = -INFINITY;
+		bool unordered = false;
+		size_t i = 0;
+
+#if defined(__SSE2__)
+		auto low = _mm_set1_pd(-INFINITY), high = _mm_set1_pd(-INFINITY), nans = _mm_setzero_pd();
+		for (; i + 4 <= size; i += 4) {
+			const auto first = _mm_loadu_pd(data + i), second = _mm_loadu_pd(data + i + 2);
+			nans = _mm_or_pd(nans, _mm_cmpunord_pd(first, second));
+			low = _mm_max_pd(low, first);
+			high = _mm_max_pd(high, second);
+		}
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_max_pd(low, high));
+		result = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+		unordered = _mm_movemask_pd(nans) != 0;
+#endif
+
+		for (; i < size; i++) {
+			const auto number = load(data, i);
+			if (number != number) unordered = true;
+			else if (number > result) result = number;
+		}
+
+		if (unordered) return NAN;
+
+		if (result == 0) {
+			for (size_t j = 0; j < size; j++) {
+				const auto number = load(data, j);
+				if (number == 0 && !std::signbit(number)) return 0;
+			}
+
+			return -0.0;
+		}
+
+		return result;
+	}
+
+} // namespace cu
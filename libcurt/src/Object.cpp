@@ -14,71 +14,348 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
+#include "Heap.h"
 #include "Object.h"
+#include "PropertyKey.h"
+#include "Shape.h"
 
 namespace cu {
 
-	std::string EmptyObject::toString() const {
-		switch (type) {
-			case ObjectType::NULL_TYPE:
-				return "null";
-			case ObjectType::UNDEFINED:
-				return "undefined";
+	constexpr size_t StringObject::MIN_ROPE_LENGTH;
+	constexpr size_t StringObject::MIN_SLICE_LENGTH;
+	constexpr size_t ArrayObject::MAX_DENSE_GAP;
+	constexpr size_t ArrayObject::MIN_DENSE_FILL;
+	constexpr size_t ArrayObject::CARD_SIZE;
+	constexpr size_t PlainObject::MAX_SHAPE_PROPERTIES;
+
+	// Checks 8 bytes at a time since most strings are ASCII.
+	static bool isASCII(const char* data, const size_t size) {
+		constexpr uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+		size_t i = 0;
+
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+			uint64_t word;
+			std::memcpy(&word, data + i, sizeof(uint64_t));
+			if (word & HIGH_BITS) return false;
+		}
+
+		for (; i < size; i++) {
+			if (static_cast<unsigned char>(data[i]) & 0x80) return false;
 		}
+
+		return true;
+	}
+
+	static char16_t readUnit(const StringUnits& units, const size_t index) {
+		char16_t unit;
+		std::memcpy(&unit, units.data + index * sizeof(char16_t), sizeof(char16_t));
+		return unit;
 	}
 
-	std::string BooleanObject::toString() const {
-		return val == true ? "true" : "false";
+	static void appendUnit(std::string& units, const char16_t unit) {
+		units.append(reinterpret_cast<const char*>(&unit), sizeof(char16_t));
 	}
 
-	std::string NumberObject::toString() const {
-		// Check if value is integral, convert to long
-		// so that we don't see the fractional part.
-		double temp;
-		if (std::modf(val, &temp) == 0.0) {
-			return std::to_string((long) val);
+	static void appendUTF8(std::string& utf8, const uint32_t codePoint) {
+		if (codePoint < 0x80) {
+			utf8 += static_cast<char>(codePoint);
+		} else if (codePoint < 0x800) {
+			utf8 += static_cast<char>(0xc0 | (codePoint >> 6));
+			utf8 += static_cast<char>(0x80 | (codePoint & 0x3f));
+		} else if (codePoint < 0x10000) {
+			utf8 += static_cast<char>(0xe0 | (codePoint >> 12));
+			utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+			utf8 += static_cast<char>(0x80 | (codePoint & 0x3f));
+		} else {
+			utf8 += static_cast<char>(0xf0 | (codePoint >> 18));
+			utf8 += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+			utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+			utf8 += static_cast<char>(0x80 | (codePoint & 0x3f));
 		}
+	}
 
-		/*
-			If not integral, call to std::to_string
-			produces trailing zeroes in the string.
-			For example, 61.6 appears as 61.600000.
+	bool StringObject::encode(const std::string& utf8, std::string& units) {
+		if (isASCII(utf8.data(), utf8.size())) {
+			units = utf8;
+			return false;
+		}
 
-			To avoid this, we erase the trailing zeroes.
-		*/
-		auto str = std::to_string(val);
-		return str.erase(str.find_last_not_of('0') + 1, std::string::npos);
+		constexpr char16_t REPLACEMENT = 0xfffd;
+
+		std::u16string wide;
+		wide.reserve(utf8.size());
+
+		for (size_t i = 0; i < utf8.size();) {
+			const unsigned char lead = utf8[i];
+			size_t count = lead < 0x80 ? 0 : lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : 4;
+			if (count == 4 || i + count >= utf8.size()) {
+				wide += REPLACEMENT;
+				i++;
+				continue;
+			}
+
+			uint32_t codePoint = count == 0 ? lead : lead & (0x3f >> count);
+			bool valid = true;
+			for (size_t k = 1; k <= count; k++) {
+				const unsigned char next = utf8[i + k];
+				if ((next & 0xc0) != 0x80) {
+					valid = false;
+					break;
+				}
+
+				codePoint = (codePoint << 6) | (next & 0x3f);
+			}
+
+			if (!valid || codePoint > 0x10ffff) {
+				wide += REPLACEMENT;
+				i++;
+				continue;
+			}
+
+			if (codePoint >= 0x10000) {
+				codePoint -= 0x10000;
+				wide += static_cast<char16_t>(0xd800 | (codePoint >> 10));
+				wide += static_cast<char16_t>(0xdc00 | (codePoint & 0x3ff));
+			} else {
+				wide += static_cast<char16_t>(codePoint);
+			}
+
+			i += count + 1;
+		}
+
+		units.clear();
+		for (const char16_t unit : wide) {
+			if (unit > 0xff) {
+				units.assign(reinterpret_cast<const char*>(wide.data()), wide.size() * sizeof(char16_t));
+				return true;
+			}
+
+			units += static_cast<char>(unit);
+		}
+
+		return false;
 	}
 
 	std::string StringObject::toString() const {
-		return val;
+		const auto data = units();
+		if (!twoByte && isASCII(data.data, data.size)) return data.str();
+
+		std::string utf8;
+		utf8.reserve(data.size);
+
+		for (size_t i = 0; i < len; i++) {
+			uint32_t codePoint = twoByte ? readUnit(data, i) : static_cast<unsigned char>(data.data[i]);
+
+			// Joins surrogate pairs, lone surrogates are encoded as-is.
+			if (codePoint >= 0xd800 && codePoint < 0xdc00 && i + 1 < len) {
+				const char16_t low = readUnit(data, i + 1);
+				if (low >= 0xdc00 && low < 0xe000) {
+					codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+					i++;
+				}
+			}
+
+			appendUTF8(utf8, codePoint);
+		}
+
+		return utf8;
+	}
+
+	char16_t StringObject::unitAt(const size_t index) const {
+		const auto data = units();
+		return twoByte ? readUnit(data, index) : static_cast<unsigned char>(data.data[index]);
+	}
+
+	void StringObject::trace(Tracer& tracer) {
+		if (form == Form::ROPE) {
+			tracer.visit(first);
+			tracer.visit(second);
+		} else if (form == Form::SLICE) {
+			tracer.visitSliceParent(*this);
+		}
+	}
+
+	void Tracer::visitSliceParent(StringObject& slice) {
+		visit(slice.first);
+	}
+
+	/*
+		Ropes built in a loop are as deep as the number of iterations,
+		so the leaves are gathered with an explicit stack instead of
+		recursing. One-byte leaves are widened when the rope is two-byte.
+	*/
+	void StringObject::flatten() const {
+		if (!isRope()) return;
+
+		std::string flat;
+		flat.reserve(len << twoByte);
+
+		std::vector<const StringObject*> pending{ this };
+		while (!pending.empty()) {
+			const StringObject* str = pending.back();
+			pending.pop_back();
+
+			if (str->isRope()) {
+				pending.push_back(str->second.asString());
+				pending.push_back(str->first.asString());
+				continue;
+			}
+
+			const auto leaf = str->units();
+			if (str->twoByte == twoByte) {
+				flat.append(leaf.data, leaf.size);
+			} else {
+				for (size_t i = 0; i < leaf.size; i++) {
+					appendUnit(flat, static_cast<unsigned char>(leaf.data[i]));
+				}
+			}
+		}
+
+		val = std::move(flat);
+		first = second = Value::undefined();
+		form = Form::FLAT;
+	}
+
+	void StringObject::copyOut() {
+		val = units().str();
+		first = Value::undefined();
+		form = Form::FLAT;
+	}
+
+	void StringObject::markInterned() {
+		interning = parseArrayIndex(units(), twoByte, index) ? Interning::INDEX : Interning::NAME;
+	}
+
+	bool StringObject::parseArrayIndex(const StringUnits& units, const bool twoByte, uint32_t& index) {
+		// Digits are one-byte units, and the largest index, 2^32 - 2, has 10.
+		if (twoByte || units.size == 0 || units.size > 10) return false;
+
+		// Leading zeros are not canonical.
+		if (units.data[0] == '0') {
+			index = 0;
+			return units.size == 1;
+		}
+
+		uint64_t value = 0;
+		for (size_t i = 0; i < units.size; i++) {
+			const char c = units.data[i];
+			if (c < '0' || c > '9') return false;
+			value = value * 10 + (c - '0');
+		}
+
+		if (value >= UINT32_MAX) return false;
+
+		index = static_cast<uint32_t>(value);
+		return true;
+	}
+
+	Value StringObject::slice(Heap& heap, const Value& value, const size_t start, const size_t end) {
+		const auto str = value.asString();
+		if (start == 0 && end == str->len) return value;
+
+		const auto data = str->units();
+		const size_t length = end - start;
+
+		// A range of a two-byte string may well fit in one byte per
+		// unit, in which case it has to be narrowed to stay canonical.
+		if (str->twoByte) {
+			std::string narrow;
+			narrow.reserve(length);
+
+			for (size_t i = start; i < end; i++) {
+				const auto unit = readUnit(data, i);
+				if (unit > 0xff) break;
+				narrow += static_cast<char>(unit);
+			}
+
+			if (narrow.size() == length) {
+				return Value::object(heap.allocate<StringObject>(std::move(narrow), false));
+			}
+		}
+
+		// Slices of slices share the characters of the original parent.
+		Value parent = value;
+		size_t base = start;
+		if (str->form == Form::SLICE) {
+			parent = str->first;
+			base += str->offset;
+		}
+
+		if (length < MIN_SLICE_LENGTH || base > UINT32_MAX) {
+			std::string copy(data.data + (start << str->twoByte), length << str->twoByte);
+			return Value::object(heap.allocate<StringObject>(std::move(copy), str->twoByte));
+		}
+
+		// The slice may have been tenured while its parent is young.
+		auto slice = heap.allocate<StringObject>(parent, static_cast<uint32_t>(base), length);
+		heap.writeBarrier(slice, parent);
+
+		return Value::object(slice);
+	}
+
+	// 64-bit FNV-1a over the code units
+	uint64_t StringObject::hashOf(const StringUnits& units) {
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < units.size; i++) {
+			hash ^= static_cast<unsigned char>(units.data[i]);
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
 	}
 
 	std::string ArrayObject::toString() const {
 		std::ostringstream buffer;
 		buffer << "[";
 
-		for (auto itr = val.begin(); itr != val.end(); itr++) {
-			buffer << itr->get()->toString();
+		if (sparse) {
+			std::vector<uint32_t> indices;
+			indices.reserve(sparse->elements.size());
+			for (const auto& element : sparse->elements) {
+				indices.push_back(element.first);
+			}
+
+			std::sort(indices.begin(), indices.end());
+
+			// Runs of missing elements are printed as a count,
+			// the same way Node prints them.
+			size_t next = 0;
+			for (auto itr = indices.begin(); itr != indices.end(); itr++) {
+				if (*itr > next) {
+					buffer << "<" << *itr - next << " empty item" << (*itr - next > 1 ? "s" : "") << ">, ";
+				}
+
+				buffer << sparse->elements.at(*itr).toString();
+				next = *itr + 1;
+
+				if (itr + 1 != indices.end() || props.size() != 0) {
+					buffer << ", ";
+				}
+			}
+		}
+
+		const auto view = elements();
+		for (auto itr = view.begin(); itr != view.end(); itr++) {
+			buffer << itr->toString();
 
-			if (itr + 1 != val.end() || props.size() != 0) {
+			if (itr + 1 != view.end() || props.size() != 0) {
 				buffer << ", ";
 			}
 		}
 
+		// Named properties are printed in the order they were added.
 		for (auto itr = props.begin(); itr != props.end(); itr++) {
-			buffer << "'" << itr->first << "': ";
-			buffer << itr->second->toString();
-
-			// itr + 1 works for std::vector because their iterators
-			// are random access. std::unordered_map has a forward iterator
-			// thus we need this hack.
-			//
-			// Reference: https://stackoverflow.com/a/28278854
-			if (std::next(itr) != props.end()) {
+			buffer << "'" << itr->key->toString() << "': ";
+			buffer << itr->value.toString();
+
+			if (itr + 1 != props.end()) {
 				buffer << ", ";
 			}
 		}
@@ -88,114 +365,568 @@ namespace cu {
 		return buffer.str();
 	}
 
-	const std::shared_ptr<Object> ArrayObject::operator[](const size_t index) const {
-		if (index < val.size()) {
-			return val[index];
+	void ArrayObject::trace(Tracer& tracer) {
+		if (shared) {
+			// Templates are constants, thus tenured, and never move.
+			Value source = Value::object(shared);
+			tracer.visit(source);
+		} else if (kind == ElementKind::GENERIC) {
+			for (auto& element : val) {
+				tracer.visit(element);
+			}
+		}
+
+		if (sparse) {
+			for (auto& element : sparse->elements) {
+				tracer.visit(element.second);
+			}
 		}
 
-		return std::make_shared<EmptyObject>(ObjectType::UNDEFINED);
+		traceProperties(tracer);
 	}
 
-	const std::shared_ptr<Object> ArrayObject::operator[](const std::shared_ptr<Object>& property) const {
-		switch (property->type) {
-			case ObjectType::NUMBER: {
-				auto index = std::dynamic_pointer_cast<NumberObject>(property)->get();
-				if (index >= 0 && index < val.size()) {
-					return val[index];
-				}
+	void ArrayObject::traceRemembered(Tracer& tracer) {
+		// Elements are only written once the template is unshared.
+		for (const size_t card : dirtyCards) {
+			const size_t start = card * CARD_SIZE;
+			const size_t end = std::min(start + CARD_SIZE, length());
 
-				break;
-			}
-			case ObjectType::ARRAY: {
-				const auto& arr = std::dynamic_pointer_cast<ArrayObject>(property)->get();
-				if (arr.size() == 1) {
-					/*
-						Emulating the following JS behaviour:
-
-						let arr = [1, 2, 3];
-						arr[[1]] -> 2
-					*/
-					const auto& index = arr[0];
-					return (*this)[index];
-				} else {
-					return props.at(property->toString());
+			for (size_t index = start; index < end; index++) {
+				if (!sparse) {
+					tracer.visit(val[index]);
+					continue;
 				}
 
-				break;
+				const auto itr = sparse->elements.find(static_cast<uint32_t>(index));
+				if (itr != sparse->elements.end()) tracer.visit(itr->second);
+			}
+		}
+
+		dirtyCards.clear();
+		cardsCompacted = 0;
+
+		// Named properties are few, and stores into them go
+		// through the plain write barrier, so trace them all.
+		traceProperties(tracer);
+	}
+
+	// Properties are never removed, so the ones before the cursor stay put.
+	static bool tracePropertiesFrom(PropertyDictionary& props, Tracer& tracer, TraceCursor& cursor, const size_t limit) {
+		const size_t end = std::min(props.size(), cursor.index + limit);
+		for (; cursor.index < end; cursor.index++) {
+			auto& prop = *(props.begin() + cursor.index);
+			Value key = Value::object(prop.key);
+			tracer.visit(key);
+			tracer.visit(prop.value);
+		}
+
+		return cursor.index == props.size();
+	}
+
+	bool ArrayObject::traceSome(Tracer& tracer, TraceCursor& cursor, const size_t limit) {
+		enum Part { ELEMENTS, PROPERTIES };
+
+		if (cursor.part == ELEMENTS) {
+			if (shared) {
+				Value source = Value::object(shared);
+				tracer.visit(source);
 			}
-			case ObjectType::STRING: {
-				auto str = std::dynamic_pointer_cast<StringObject>(property)->get();
-				try {
-					auto index = std::stod(str);
 
-					if (index >= 0 && index < val.size()) {
-						return val[index];
+			if (cursor.layout != layout) {
+				cursor.layout = layout;
+				cursor.index = 0;
+			}
+
+			// Sparse elements are traced a bucket at a time.
+			if (sparse) {
+				const size_t buckets = sparse->elements.bucket_count();
+				const size_t end = std::min(buckets, cursor.index + limit);
+
+				for (; cursor.index < end; cursor.index++) {
+					auto itr = sparse->elements.begin(cursor.index);
+					for (; itr != sparse->elements.end(cursor.index); itr++) {
+						tracer.visit(itr->second);
 					}
-				} catch(std::invalid_argument err) {}
+				}
+
+				if (cursor.index < buckets) return false;
+			} else if (kind == ElementKind::GENERIC) {
+				const size_t end = std::min(val.size(), cursor.index + limit);
+				for (; cursor.index < end; cursor.index++) {
+					tracer.visit(val[cursor.index]);
+				}
+
+				if (cursor.index < val.size()) return false;
+			}
+
+			cursor.part = PROPERTIES;
+			cursor.index = 0;
+		}
+
+		return tracePropertiesFrom(props, tracer, cursor, limit);
+	}
+
+	void ArrayObject::traceProperties(Tracer& tracer) {
+		for (auto& prop : props) {
+			// Keys are interned, thus tenured, and never move.
+			Value key = Value::object(prop.key);
+			tracer.visit(key);
+			tracer.visit(prop.value);
+		}
+	}
+
+	void ArrayObject::markCards(const size_t start, const size_t end) {
+		for (size_t card = start / CARD_SIZE; card * CARD_SIZE < end; card++) {
+			// Consecutive stores, such as pushes, mostly hit the same card.
+			if (!dirtyCards.empty() && dirtyCards.back() == card) continue;
+			dirtyCards.push_back(static_cast<uint32_t>(card));
+		}
+
+		// Stores all over the array would otherwise grow the list without
+		// bounds until the next minor collection.
+		if (dirtyCards.size() >= 2 * cardsCompacted + CARD_SIZE) {
+			std::sort(dirtyCards.begin(), dirtyCards.end());
+			dirtyCards.erase(std::unique(dirtyCards.begin(), dirtyCards.end()), dirtyCards.end());
+			cardsCompacted = dirtyCards.size();
+		}
+	}
+
+	size_t ArrayObject::footprint() const {
+		size_t sparseSize = 0;
+		if (sparse) {
+			sparseSize = sizeof(SparseElements);
+			for (const auto& element : sparse->elements) {
+				sparseSize += sizeof(element);
+			}
+		}
+
+		return sizeof(ArrayObject) + val.capacity() * sizeof(Value) + sparseSize + props.footprint();
+	}
+
+	void ArrayObject::push(const Value& value) {
+		if (sparse) {
+			setElement(sparse->length, value);
+		} else {
+			if (!value.isNumber()) kind = ElementKind::GENERIC;
+			unshare();
+			val.push_back(value);
+		}
+	}
 
-				break;
+	Value ArrayObject::pop() {
+		if (length() == 0) return Value::undefined();
+
+		if (sparse) {
+			const auto index = static_cast<uint32_t>(--sparse->length);
+			const auto itr = sparse->elements.find(index);
+			if (itr == sparse->elements.end()) return Value::undefined();
+
+			const auto last = itr->second;
+			sparse->elements.erase(itr);
+			return last;
+		}
+
+		unshare();
+		const auto last = val.back();
+		val.pop_back();
+		return last;
+	}
+
+	void ArrayObject::fill(const Value& value, const size_t start, const size_t end) {
+		if (sparse) {
+			for (size_t index = start; index < end; index++) {
+				setElement(static_cast<uint32_t>(index), value);
 			}
+
+			return;
 		}
 
-		return std::make_shared<EmptyObject>(ObjectType::UNDEFINED);
+		if (!value.isNumber()) kind = ElementKind::GENERIC;
+		unshare();
+		std::fill(val.begin() + start, val.begin() + end, value);
 	}
 
-	std::shared_ptr<Object>& ArrayObject::operator[](const std::shared_ptr<Object>& property) {
-		switch (property->type) {
-			case ObjectType::NUMBER: {
-				auto index = std::dynamic_pointer_cast<NumberObject>(property)->get();
-				if (index >= 0 && index < val.size()) {
-					return val[index];
-				} else {
-					// Resize to double of the required index + 1 to handle
-					// the base case of when required index is 0.
-					val.resize((index + 1) * 2, std::make_shared<EmptyObject>(ObjectType::UNDEFINED));
-					return val[index];
+	std::vector<uint32_t> ArrayObject::sparseIndices() const {
+		std::vector<uint32_t> indices;
+		indices.reserve(sparse->elements.size());
+
+		for (const auto& element : sparse->elements) {
+			indices.push_back(element.first);
+		}
+
+		std::sort(indices.begin(), indices.end());
+		return indices;
+	}
+
+	const Value ArrayObject::operator[](const size_t index) const {
+		if (sparse) {
+			const auto itr = sparse->elements.find(index);
+			return itr != sparse->elements.end() ? itr->second : Value::undefined();
+		}
+
+		const auto& elements = dense();
+		if (index < elements.size()) {
+			return elements[index];
+		}
+
+		return Value::undefined();
+	}
+
+	void ArrayObject::setElement(const uint32_t index, const Value& value) {
+		if (!sparse) {
+			if (!value.isNumber()) kind = ElementKind::GENERIC;
+			unshare();
+
+			if (index < val.size()) {
+				val[index] = value;
+				return;
+			}
+
+			// Growing a small array is cheap even if it leaves a hole.
+			const auto gap = index - val.size();
+			if (gap <= MAX_DENSE_GAP || gap <= val.size()) {
+				if (gap > 0) kind = ElementKind::GENERIC;
+				val.resize(index + 1, Value::undefined());
+				val[index] = value;
+				return;
+			}
+
+			makeSparse();
+		}
+
+		const size_t buckets = sparse->elements.bucket_count();
+		sparse->elements[index] = value;
+		sparse->length = std::max(sparse->length, static_cast<size_t>(index) + 1);
+
+		// Rehashing moves elements to other buckets.
+		if (sparse->elements.bucket_count() != buckets) layout++;
+
+		if (sparse->elements.size() * 100 >= sparse->length * MIN_DENSE_FILL) {
+			makeDense();
+		}
+	}
+
+	void ArrayObject::makeSparse() {
+		layout++;
+		sparse.reset(new SparseElements());
+		kind = ElementKind::GENERIC;
+		sparse->length = val.size();
+		sparse->elements.reserve(val.size());
+
+		for (uint32_t i = 0; i < val.size(); i++) {
+			sparse->elements[i] = val[i];
+		}
+
+		std::vector<Value>().swap(val);
+	}
+
+	void ArrayObject::makeDense() {
+		layout++;
+		val.assign(sparse->length, Value::undefined());
+
+		for (const auto& element : sparse->elements) {
+			val[element.first] = element.second;
+		}
+
+		sparse.reset();
+	}
+
+	static bool isLength(const StringObject* name) {
+		static const StringUnits LENGTH{ "length", 6 };
+		return name != nullptr && !name->isTwoByte() && name->units() == LENGTH;
+	}
+
+	const Value ArrayObject::get(const Value& property, const Heap& heap) const {
+		const auto key = PropertyKey::find(property, heap);
+		if (key.isIndex()) return (*this)[key.getIndex()];
+
+		// A name that was never interned cannot be a key of any object.
+		if (key.getName() == nullptr) return Value::undefined();
+
+		if (isLength(key.getName())) return Value::number(length());
+
+		const auto value = props.find(key.getName());
+		return value != nullptr ? *value : Value::undefined();
+	}
+
+	void ArrayObject::set(const Value& property, const Value& value, Heap& heap) {
+		const auto key = PropertyKey::from(property, heap);
+
+		if (key.isIndex()) {
+			setElement(key.getIndex(), value);
+			heap.writeBarrier(this, key.getIndex(), value);
+			return;
+		}
+
+		if (isLength(key.getName())) return;
+
+		props.set(key.getName(), value);
+		heap.writeBarrier(this, Value::object(key.getName()));
+		heap.writeBarrier(this, value);
+	}
+
+	std::string PlainObject::toString() const {
+		std::ostringstream buffer;
+		buffer << "{";
+
+		if (shape != nullptr) {
+			const auto& keys = shape->getKeys();
+			for (size_t slot = 0; slot < keys.size(); slot++) {
+				buffer << "'" << keys[slot]->toString() << "': " << slots[slot].toString();
+
+				if (slot + 1 != keys.size()) {
+					buffer << ", ";
 				}
+			}
+		} else {
+			for (auto itr = dictionary->begin(); itr != dictionary->end(); itr++) {
+				buffer << "'" << itr->key->toString() << "': " << itr->value.toString();
 
-				break;
-			}
-			case ObjectType::ARRAY: {
-				const auto& arr = std::dynamic_pointer_cast<ArrayObject>(property)->get();
-				if (arr.size() == 1) {
-					/*
-						Emulating the following JS behaviour:
-
-						let arr = [1, 2, 3];
-						arr[[1]] -> 2
-					*/
-					const auto& index = arr[0];
-					return (*this)[index];
-				} else {
-					const auto& propStr = property->toString();
-					props[propStr] = std::make_shared<EmptyObject>(ObjectType::UNDEFINED);
-					return props[propStr];
+				if (itr + 1 != dictionary->end()) {
+					buffer << ", ";
 				}
+			}
+		}
+
+		buffer << "}";
+
+		return buffer.str();
+	}
+
+	void PlainObject::trace(Tracer& tracer) {
+		// Shapes are tenured and never move.
+		if (shape != nullptr) {
+			Value layout = Value::object(shape);
+			tracer.visit(layout);
+		}
+
+		for (auto& slot : slots) {
+			tracer.visit(slot);
+		}
 
-				break;
+		if (dictionary) {
+			for (auto& prop : *dictionary) {
+				Value key = Value::object(prop.key);
+				tracer.visit(key);
+				tracer.visit(prop.value);
 			}
-			case ObjectType::STRING: {
-				auto str = std::dynamic_pointer_cast<StringObject>(property)->get();
-				try {
-					auto index = std::stod(str);
+		}
+	}
 
-					if (index >= 0 && index < val.size()) {
-						return val[index];
-					} else {
-						// Resize to double of the required index + 1 to handle
-						// the base case of when required index is 0.
-						val.resize((index + 1) * 2, std::make_shared<EmptyObject>(ObjectType::UNDEFINED));
-						return val[index];
-					}
-				} catch(std::invalid_argument err) {}
+	bool PlainObject::traceSome(Tracer& tracer, TraceCursor& cursor, const size_t limit) {
+		// There are at most MAX_SHAPE_PROPERTIES slots, so they are traced
+		// at once. Once in dictionary mode, the object keeps its entries.
+		if (cursor.part == 0) {
+			if (shape != nullptr) {
+				Value layout = Value::object(shape);
+				tracer.visit(layout);
+			}
 
-				break;
+			for (auto& slot : slots) {
+				tracer.visit(slot);
 			}
+
+			cursor.part = 1;
+		}
+
+		if (!dictionary) return true;
+		return tracePropertiesFrom(*dictionary, tracer, cursor, limit);
+	}
+
+	size_t PlainObject::footprint() const {
+		size_t dictionarySize = 0;
+		if (dictionary) {
+			dictionarySize = sizeof(PropertyDictionary) + dictionary->footprint();
 		}
 
-		const auto& propStr = property->toString();
-		props[propStr] = std::make_shared<EmptyObject>(ObjectType::UNDEFINED);
-		return props[propStr];
+		return sizeof(PlainObject) + slots.capacity() * sizeof(Value) + dictionarySize;
+	}
+
+	const Value PlainObject::get(const Value& property, const Heap& heap) const {
+		const StringObject* key = PropertyKey::find(property, heap).findName(heap);
+		if (key == nullptr) return Value::undefined();
+
+		if (shape != nullptr) {
+			const auto slot = shape->lookup(key);
+			return slot != Shape::NOT_FOUND ? slots[slot] : Value::undefined();
+		}
+
+		const auto value = dictionary->find(key);
+		return value != nullptr ? *value : Value::undefined();
+	}
+
+	void PlainObject::set(const Value& property, const Value& value, Heap& heap) {
+		StringObject* key = PropertyKey::from(property, heap).toName(heap);
+
+		if (shape != nullptr) {
+			const auto slot = shape->lookup(key);
+			if (slot != Shape::NOT_FOUND) {
+				slots[slot] = value;
+				heap.writeBarrier(this, value);
+				return;
+			}
+
+			// Keys computed at runtime, unlike those from the source, are
+			// interned on the spot, and would each add a shape of their own.
+			const bool literal = property.isString() && property.asString()->isInterned();
+
+			if (literal && shape->propertyCount() < MAX_SHAPE_PROPERTIES) {
+				shape = heap.addProperty(shape, key);
+				heap.writeBarrier(this, Value::object(shape));
+
+				slots.push_back(value);
+				heap.writeBarrier(this, value);
+				return;
+			}
+
+			makeDictionary();
+		}
+
+		dictionary->set(key, value);
+		heap.writeBarrier(this, Value::object(key));
+		heap.writeBarrier(this, value);
+	}
+
+	void PlainObject::setSlot(const size_t slot, const Value& value, Heap& heap) {
+		slots[slot] = value;
+		heap.writeBarrier(this, value);
+	}
+
+	void PlainObject::addSlot(Shape* transition, const Value& value, Heap& heap) {
+		shape = transition;
+		heap.writeBarrier(this, Value::object(shape));
+
+		slots.push_back(value);
+		heap.writeBarrier(this, value);
+	}
+
+	void PlainObject::makeDictionary() {
+		dictionary.reset(new PropertyDictionary());
+
+		const auto& keys = shape->getKeys();
+		for (size_t slot = 0; slot < keys.size(); slot++) {
+			dictionary->set(keys[slot], slots[slot]);
+		}
+
+		// The keys were already reachable through the shape,
+		// so this needs no write barrier.
+		shape = nullptr;
+		std::vector<Value>().swap(slots);
+	}
+
+	std::string MapObject::toString() const {
+		std::ostringstream buffer;
+		buffer << "Map {";
+
+		bool first = true;
+		for (const auto& entry : table.getEntries()) {
+			if (entry.removed) continue;
+
+			if (!first) buffer << ", ";
+			buffer << entry.key.toString() << " => " << entry.value.toString();
+			first = false;
+		}
+
+		buffer << "}";
+
+		return buffer.str();
+	}
+
+	void MapObject::set(const Value& key, const Value& value, Heap& heap) {
+		table.set(key, value);
+		heap.writeBarrier(this, key);
+		heap.writeBarrier(this, value);
+	}
+
+	std::string SetObject::toString() const {
+		std::ostringstream buffer;
+		buffer << "Set {";
+
+		bool first = true;
+		for (const auto& entry : table.getEntries()) {
+			if (entry.removed) continue;
+
+			if (!first) buffer << ", ";
+			buffer << entry.key.toString();
+			first = false;
+		}
+
+		buffer << "}";
+
+		return buffer.str();
+	}
+
+	void SetObject::add(const Value& value, Heap& heap) {
+		table.set(value, Value::undefined());
+		heap.writeBarrier(this, value);
+	}
+
+	size_t TypedArrayObject::elementSize(const ElementType elementType) {
+		switch (elementType) {
+			case ElementType::FLOAT64: return sizeof(double);
+			case ElementType::INT32: return sizeof(int32_t);
+			default: return sizeof(uint8_t);
+		}
+	}
+
+	const char* TypedArrayObject::name(const ElementType elementType) {
+		switch (elementType) {
+			case ElementType::FLOAT64: return "Float64Array";
+			case ElementType::INT32: return "Int32Array";
+			default: return "Uint8Array";
+		}
+	}
+
+	std::string TypedArrayObject::toString() const {
+		std::ostringstream buffer;
+		buffer << name(elementType) << "(" << count << ") [";
+
+		for (size_t index = 0; index < count; index++) {
+			if (index != 0) buffer << ", ";
+			buffer << getElement(index).toString();
+		}
+
+		buffer << "]";
+
+		return buffer.str();
+	}
+
+	size_t TypedArrayObject::footprint() const {
+		// The pages of a mapped file are backed by the file, so
+		// they do not count towards the size of the heap.
+		return sizeof(TypedArrayObject) + (buffer.isMapped() ? 0 : buffer.size());
+	}
+
+	const Value TypedArrayObject::get(const Value& property, const Heap& heap) const {
+		const auto key = PropertyKey::find(property, heap);
+		if (key.isIndex()) {
+			return key.getIndex() < count ? getElement(key.getIndex()) : Value::undefined();
+		}
+
+		return isLength(key.getName()) ? Value::number(count) : Value::undefined();
+	}
+
+	void TypedArrayObject::set(const Value& property, const Value& value, const Heap& heap) {
+		const auto key = PropertyKey::find(property, heap);
+		if (!key.isIndex() || key.getIndex() >= count) return;
+
+		setElement(key.getIndex(), toNumber(value));
+	}
+
+	double TypedArrayObject::toNumber(const Value& value) {
+		if (value.isNumber()) return value.asNumber();
+		if (value.isBoolean()) return value.asBoolean();
+		if (value.isNull()) return 0;
+		return NAN;
+	}
+
+	int32_t TypedArrayObject::wrapInt32(const double number) {
+		if (!std::isfinite(number)) return 0;
+
+		double wrapped = std::fmod(std::trunc(number), 4294967296.0);
+		if (wrapped < 0) wrapped += 4294967296.0;
+
+		return static_cast<int32_t>(static_cast<uint32_t>(wrapped));
 	}
 
 	std::ostream& operator<<(std::ostream& stream, const Object& obj) {
@@ -0,0 +1,444 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "Object.h"
+#include "Optimizer.h"
+
+namespace cu {
+
+	enum class Operands { NONE, ONE, ONE_AND_BYTE, JUMP, REGISTER };
+
+	static Operands operandsOf(const OpCode opcode) {
+		switch (opcode) {
+			case LDC: case POPN: case LDVAR: case SETVAR: case POPVAR:
+			case NEWARR: case CLONEARR: case NEWOBJ: case NEWMAP: case NEWSET:
+			case SETPROP: case LDPROP: case INCVAR: case DECVAR:
+				return Operands::ONE;
+			case NEWTYPED: case INVOKE:
+				return Operands::ONE_AND_BYTE;
+			case JMP: case JNT: case JIT: case LOOP:
+				return Operands::JUMP;
+			case ADDR: case SUBR: case MULR: case DIVR: case MODR:
+			case GRTR: case LSTR: case GRER: case LSER: case EQUR: case NEQR:
+				return Operands::REGISTER;
+			default:
+				return Operands::NONE;
+		}
+	}
+
+	// Once decoded, LOOP is a JMP that lands before itself.
+	static bool isJump(const OpCode opcode) {
+		return opcode == JMP || opcode == JNT || opcode == JIT;
+	}
+
+	void Optimizer::optimize(Bytecode& bytecode) {
+		code.clear();
+		if (!decode(bytecode)) return;
+
+		// A rewrite may uncover another, thus repeat until none applies.
+		bool changed = true;
+		while (changed) {
+			changed = threadJumps();
+			changed |= foldConstantConditions(bytecode);
+			changed |= fuseInstructions();
+			changed |= removeUnreachable();
+		}
+
+		encode(bytecode);
+	}
+
+	bool Optimizer::decode(const Bytecode& bytecode) {
+		const auto& blob = bytecode.blob;
+		locations = bytecode.locationInfo.expand();
+		if (locations.size() != blob.size()) return false;
+
+		// The instruction at every offset, and NONE in between.
+		constexpr size_t NONE = SIZE_MAX;
+		std::vector<size_t> indices(blob.size() + 1, NONE);
+
+		for (size_t ip = 0; ip < blob.size();) {
+			const size_t start = ip;
+			const bool wide = blob[ip] == WIDE;
+			if (wide) ip++;
+
+			if (ip >= blob.size() || blob[ip] > RET) return false;
+
+			Instruction instruction;
+			instruction.opcode = static_cast<OpCode>(blob[ip++]);
+			instruction.offset = start;
+
+			const auto operands = operandsOf(instruction.opcode);
+			switch (operands) {
+				case Operands::NONE:
+					if (wide) return false;
+					break;
+
+				case Operands::ONE:
+				case Operands::ONE_AND_BYTE: {
+					const size_t size = wide ? 4 : 1;
+					const size_t extra = operands == Operands::ONE_AND_BYTE ? 1 : 0;
+					if (ip + size + extra > blob.size()) return false;
+
+					instruction.operand = wide ? Bytecode::readWord(&blob[ip]) : blob[ip];
+					ip += size;
+
+					if (extra) instruction.second = blob[ip++];
+					break;
+				}
+
+				case Operands::JUMP: {
+					const size_t size = wide ? 4 : 2;
+					if (ip + size > blob.size()) return false;
+
+					const size_t distance = wide ? Bytecode::readWord(&blob[ip]) : Bytecode::readShort(&blob[ip]);
+					ip += size;
+
+					// Distances are counted from the next instruction.
+					if (instruction.opcode == LOOP) {
+						if (distance > ip) return false;
+						instruction.opcode = JMP;
+						instruction.operand = ip - distance;
+					} else {
+						if (ip + distance > blob.size()) return false;
+						instruction.operand = ip + distance;
+					}
+
+					break;
+				}
+
+				case Operands::REGISTER:
+					if (wide || ip + 2 > blob.size()) return false;
+
+					instruction.operand = blob[ip];
+					instruction.second = blob[ip + 1];
+					ip += 2;
+					break;
+			}
+
+			instruction.length = ip - start;
+
+			indices[start] = code.size();
+			code.push_back(instruction);
+		}
+
+		indices[blob.size()] = code.size();
+
+		// From here on, jumps land on instructions rather than offsets.
+		for (auto& instruction : code) {
+			if (!isJump(instruction.opcode)) continue;
+
+			instruction.operand = indices[instruction.operand];
+			if (instruction.operand == NONE) return false;
+		}
+
+		return true;
+	}
+
+	void Optimizer::encode(Bytecode& bytecode) const {
+		// A jump takes a wide distance if it lands too far away, which moves
+		// the instructions after it, and may push other jumps too far.
+		// Distances only grow as jumps widen, thus this settles.
+		std::vector<size_t> offsets(code.size() + 1);
+		std::vector<bool> wideJumps(code.size(), false);
+
+		for (bool settled = false; !settled;) {
+			size_t offset = 0;
+			for (size_t i = 0; i < code.size(); i++) {
+				offsets[i] = offset;
+
+				const auto& instruction = code[i];
+				switch (operandsOf(instruction.opcode)) {
+					case Operands::NONE: offset += 1; break;
+					case Operands::ONE: offset += instruction.operand > UINT8_MAX ? 6 : 2; break;
+					case Operands::ONE_AND_BYTE: offset += instruction.operand > UINT8_MAX ? 7 : 3; break;
+					case Operands::JUMP: offset += wideJumps[i] ? 6 : 3; break;
+					case Operands::REGISTER: offset += 3; break;
+				}
+			}
+
+			offsets[code.size()] = offset;
+
+			settled = true;
+			for (size_t i = 0; i < code.size(); i++) {
+				const auto& instruction = code[i];
+				if (!isJump(instruction.opcode) || wideJumps[i]) continue;
+
+				const size_t next = offsets[i] + 3;
+				const size_t target = offsets[instruction.operand];
+
+				if ((target < next ? next - target : target - next) > UINT16_MAX) {
+					wideJumps[i] = true;
+					settled = false;
+				}
+			}
+		}
+
+		bytecode.blob.clear();
+
+		for (size_t i = 0; i < code.size(); i++) {
+			const auto& instruction = code[i];
+			const auto& loc = locations[instruction.offset];
+
+			switch (operandsOf(instruction.opcode)) {
+				case Operands::NONE:
+					bytecode.emit(instruction.opcode, loc);
+					break;
+
+				case Operands::ONE:
+					bytecode.emit(instruction.opcode, instruction.operand, loc);
+					break;
+
+				case Operands::ONE_AND_BYTE:
+				case Operands::REGISTER:
+					bytecode.emit(instruction.opcode, instruction.operand, instruction.second, loc);
+					break;
+
+				case Operands::JUMP: {
+					if (instruction.operand <= i) {
+						bytecode.emitLoop(offsets[instruction.operand], loc);
+						break;
+					}
+
+					if (wideJumps[i]) {
+						bytecode.emitByte(WIDE, loc);
+						bytecode.emitByte(instruction.opcode, loc);
+						bytecode.emitWord(offsets[instruction.operand] - (offsets[i] + 6), loc);
+						break;
+					}
+
+					const size_t distance = offsets[instruction.operand] - (offsets[i] + 3);
+					bytecode.emitByte(instruction.opcode, loc);
+					bytecode.emitByte(distance & 0xFF, loc);
+					bytecode.emitByte(distance >> 8, loc);
+					break;
+				}
+			}
+		}
+
+		// Every byte keeps its location. The bytes of an instruction that
+		// grew, such as a jump that became wide, take that of its last one.
+		bytecode.locationInfo.clear();
+
+		for (size_t i = 0; i < code.size(); i++) {
+			const auto& instruction = code[i];
+
+			for (size_t at = 0; at < offsets[i + 1] - offsets[i]; at++) {
+				bytecode.locationInfo.add(locations[instruction.offset + std::min(at, instruction.length - 1)]);
+			}
+		}
+	}
+
+	bool Optimizer::threadJumps() {
+		bool changed = false;
+
+		for (size_t i = 0; i < code.size(); i++) {
+			auto& jump = code[i];
+			if (!isJump(jump.opcode)) continue;
+
+			// Follow the jumps that take the same path from where this one
+			// lands. A JNT that lands on a JNT, for one, finds the same value
+			// falsy again. Conditional jumps can only go forward though.
+			size_t target = jump.operand;
+			size_t landing = jump.operand;
+			size_t steps = 0;
+
+			for (; steps < code.size() && target < code.size(); steps++) {
+				const auto& next = code[target];
+				if (next.opcode != JMP && next.opcode != jump.opcode) break;
+
+				target = next.operand;
+				if (jump.opcode == JMP || target > i) landing = target;
+			}
+
+			// Jumps that go round in circles, as in while (true) {}, stay.
+			if (steps == code.size()) continue;
+
+			if (landing != jump.operand) {
+				jump.operand = landing;
+				changed = true;
+			}
+
+			// JIT still checks its operand, even if it jumps nowhere.
+			if (jump.operand == i + 1 && jump.opcode != JIT) {
+				jump.removed = true;
+				changed = true;
+			}
+		}
+
+		compact();
+		return changed;
+	}
+
+	bool Optimizer::foldConstantConditions(const Bytecode& bytecode) {
+		findTargets();
+
+		bool changed = false;
+		for (size_t i = 0; i + 1 < code.size(); i++) {
+			auto& jump = code[i + 1];
+			if (code[i].opcode != LDC || jump.isTarget) continue;
+
+			const auto& condition = bytecode.constants[code[i].operand];
+
+			if (jump.opcode == JNT) {
+				if (condition.isTruthy()) {
+					jump.removed = true;
+				} else {
+					jump.opcode = JMP;
+				}
+
+				changed = true;
+			} else if (jump.opcode == JIT && condition.isBoolean()) {
+				if (condition.asBoolean()) {
+					jump.opcode = JMP;
+				} else {
+					jump.removed = true;
+				}
+
+				changed = true;
+			}
+		}
+
+		compact();
+		return changed;
+	}
+
+	bool Optimizer::fuseInstructions() {
+		findTargets();
+
+		// Whether the condition of a JNT is popped right after, whether it jumps or not.
+		const auto poppedEitherWay = [this](const size_t jnt) {
+			const auto target = code[jnt].operand;
+			return jnt + 1 < code.size() && code[jnt + 1].opcode == POP &&
+				target < code.size() && code[target].opcode == POP;
+		};
+
+		bool changed = false;
+		for (size_t i = 0; i < code.size(); i++) {
+			auto& first = code[i];
+
+			// Left behind by blocks that declare nothing.
+			if (first.opcode == POPN && first.operand == 0) {
+				first.removed = true;
+				changed = true;
+				continue;
+			}
+
+			// Jumps may land on the first instruction of a sequence, but
+			// not in the middle of one.
+			if (i + 1 == code.size() || code[i + 1].isTarget) continue;
+			auto& second = code[i + 1];
+
+			if (first.opcode == SETVAR && second.opcode == POP) {
+				first.opcode = POPVAR;
+				second.removed = true;
+			} else if ((first.opcode == LDC || first.opcode == LDVAR) && second.opcode == POP) {
+				first.removed = true;
+				second.removed = true;
+			} else if (first.opcode == LDVAR && (second.opcode == INCVAR || second.opcode == DECVAR) &&
+					i + 2 < code.size() && !code[i + 2].isTarget && code[i + 2].opcode == POP) {
+				// x++ as a statement
+				first.removed = true;
+				code[i + 2].removed = true;
+				i++;
+			} else if (first.opcode == NOT && second.opcode == JNT && poppedEitherWay(i + 1)) {
+				second.opcode = JIT;
+				first.removed = true;
+			} else {
+				continue;
+			}
+
+			changed = true;
+			i++;
+		}
+
+		compact();
+		return changed;
+	}
+
+	bool Optimizer::removeUnreachable() {
+		if (code.empty()) return false;
+
+		std::vector<bool> reached(code.size(), false);
+		std::vector<size_t> worklist = { 0 };
+
+		while (!worklist.empty()) {
+			size_t i = worklist.back();
+			worklist.pop_back();
+
+			// Straight-line code runs until a JMP, LOOP or RET.
+			for (; i < code.size() && !reached[i]; i++) {
+				reached[i] = true;
+
+				const auto& instruction = code[i];
+				if (isJump(instruction.opcode)) worklist.push_back(instruction.operand);
+				if (instruction.opcode == JMP || instruction.opcode == RET) break;
+			}
+		}
+
+		bool changed = false;
+		for (size_t i = 0; i < code.size(); i++) {
+			if (reached[i]) continue;
+
+			code[i].removed = true;
+			changed = true;
+		}
+
+		compact();
+		return changed;
+	}
+
+	void Optimizer::compact() {
+		// The index of every instruction once compacted, or for a removed
+		// one, that of the next instruction left.
+		std::vector<size_t> indices(code.size() + 1);
+
+		size_t count = 0;
+		for (size_t i = 0; i < code.size(); i++) {
+			indices[i] = count;
+			if (!code[i].removed) count++;
+		}
+
+		indices[code.size()] = count;
+		if (count == code.size()) return;
+
+		std::vector<Instruction> compacted;
+		compacted.reserve(count);
+
+		for (auto& instruction : code) {
+			if (instruction.removed) continue;
+
+			if (isJump(instruction.opcode)) instruction.operand = indices[instruction.operand];
+			compacted.push_back(instruction);
+		}
+
+		code.swap(compacted);
+	}
+
+	void Optimizer::findTargets() {
+		for (auto& instruction : code) {
+			instruction.isTarget = false;
+		}
+
+		for (const auto& instruction : code) {
+			if (isJump(instruction.opcode) && instruction.operand < code.size()) {
+				code[instruction.operand].isTarget = true;
+			}
+		}
+	}
+
+} // namespace cu
@@ -15,6 +15,7 @@
  */
 
 #include <iostream>
+#include <unordered_map>
 
 #include "Colors.h"
 #include "Parser.h"
@@ -35,6 +36,8 @@ namespace cu {
 			}
 		}
 
+		bytecode.emit(OpCode::RET, peek().getLocation());
+		bytecode.shrinkJumps();
 		return success;
 	}
 
@@ -86,9 +89,15 @@ namespace cu {
 		return peek().getType() == TokenType::EOF_TYPE;
 	}
 
-	byte Parser::emitJump(OpCode op) {
-		bytecode.emit(op, 0, peek().getLocation());
-		return bytecode.size() - 1;
+	size_t Parser::emitJump(OpCode op) {
+		return bytecode.emitJump(op, peek().getLocation());
+	}
+
+	bool Parser::patchJump(const size_t jumpOffset) {
+		if (bytecode.patchJump(jumpOffset)) return true;
+
+		error("Too much code to jump over");
+		return false;
 	}
 
 	void Parser::synchronize() {
@@ -158,7 +167,7 @@ namespace cu {
 				return false;
 			}
 			
-			auto const &constOffset = bytecode.addConstant(new EmptyObject(ObjectType::UNDEFINED));
+			auto const &constOffset = bytecode.addConstant(Value::undefined());
 			bytecode.emit(OpCode::LDC, constOffset, peek().getLocation());
 		}
 
@@ -238,8 +247,7 @@ namespace cu {
 		auto expressionStartToken = peek();
 		if (!expression()) return false;
 
-		bytecode.emit(OpCode::JNT, 0, expressionStartToken.getLocation());
-		auto jntOffset = bytecode.size() - 1;
+		auto jntOffset = bytecode.emitJump(OpCode::JNT, expressionStartToken.getLocation());
 		bytecode.emit(OpCode::POP, expressionStartToken.getLocation());
 
 		if (!match(TokenType::CLOSE_PAREN)) {
@@ -249,21 +257,15 @@ namespace cu {
 
 		if (!statement()) return false;
 
-		bytecode.emit(OpCode::JMP, 0, expressionStartToken.getLocation());
-		auto jmpOffset = bytecode.size() - 1;
-
-		auto afterIfBodyOffset = bytecode.size();
-		bytecode.patch(jntOffset, afterIfBodyOffset);
+		auto jmpOffset = bytecode.emitJump(OpCode::JMP, expressionStartToken.getLocation());
+		if (!patchJump(jntOffset)) return false;
 
 		bytecode.emit(OpCode::POP, expressionStartToken.getLocation());
 		if (match(TokenType::ELSE)) {
 			if (!statement()) return false;
 		}
 
-		auto afterElseBodyOffset = bytecode.size();
-		bytecode.patch(jmpOffset, afterElseBodyOffset);
-
-		return true;
+		return patchJump(jmpOffset);
 	}
 
 	bool Parser::forStatement() {
@@ -287,8 +289,9 @@ namespace cu {
 			if (!expressionStatement()) return false;
 		}
 
-		byte nextIteration = bytecode.size();
-		int toEndOfLoop = -1;
+		size_t nextIteration = bytecode.size();
+		bool hasCondition = false;
+		size_t toEndOfLoop = 0;
 
 		// Exit condition is optional
 		if (!match(TokenType::SEMICOLON)) {
@@ -299,15 +302,18 @@ namespace cu {
 				return false;
 			}
 
+			hasCondition = true;
 			toEndOfLoop = emitJump(OpCode::JNT);
 			bytecode.emit(OpCode::POP, peek().getLocation());
 		}
 
-		byte toIncrement = nextIteration;
-		int toBody = -1;
+		size_t toIncrement = nextIteration;
+		bool hasIncrement = false;
+		size_t toBody = 0;
 
 		// Increment expression is optional
 		if (!match(TokenType::CLOSE_PAREN)) {
+			hasIncrement = true;
 			toBody = emitJump(OpCode::JMP);
 			toIncrement = bytecode.size();
 
@@ -319,25 +325,23 @@ namespace cu {
 			}
 
 			bytecode.emit(OpCode::POP, peek().getLocation());
-			bytecode.emit(OpCode::JMP, nextIteration, peek().getLocation());
+			bytecode.emitLoop(nextIteration, peek().getLocation());
 		}
 
-		if (toBody != -1) {
-			bytecode.patch(toBody, bytecode.size());
-		}
+		if (hasIncrement && !patchJump(toBody)) return false;
 
 		loopStack.push(LoopJumpOffsets(toIncrement));
 		if (!statement()) return false;
 
-		bytecode.emit(OpCode::JMP, toIncrement, peek().getLocation());
+		bytecode.emitLoop(toIncrement, peek().getLocation());
 
-		if (toEndOfLoop != -1) {
-			bytecode.patch(toEndOfLoop, bytecode.size());
+		if (hasCondition) {
+			if (!patchJump(toEndOfLoop)) return false;
 			bytecode.emit(OpCode::POP, peek().getLocation());
 		}
 
 		for (const auto& breakPatch : loopStack.top().breakPatches) {
-			bytecode.patch(breakPatch, bytecode.size());
+			if (!patchJump(breakPatch)) return false;
 		}
 		loopStack.pop();
 
@@ -357,7 +361,7 @@ namespace cu {
 		auto expressionStartToken = peek();
 		if (!expression()) return false;
 
-		byte toEndOfLoop = emitJump(OpCode::JNT);
+		auto toEndOfLoop = emitJump(OpCode::JNT);
 		bytecode.emit(OpCode::POP, expressionStartToken.getLocation());
 
 		if (!match(TokenType::CLOSE_PAREN)) {
@@ -368,13 +372,13 @@ namespace cu {
 		loopStack.push(LoopJumpOffsets(nextIteration));
 		if (!statement()) return false;
 
-		bytecode.emit(OpCode::JMP, nextIteration, expressionStartToken.getLocation());
+		bytecode.emitLoop(nextIteration, expressionStartToken.getLocation());
 		
-		bytecode.patch(toEndOfLoop, bytecode.size());
+		if (!patchJump(toEndOfLoop)) return false;
 		bytecode.emit(OpCode::POP, expressionStartToken.getLocation());
 
 		for (const auto& breakPatch : loopStack.top().breakPatches) {
-			bytecode.patch(breakPatch, bytecode.size());
+			if (!patchJump(breakPatch)) return false;
 		}
 		loopStack.pop();
 
@@ -412,7 +416,7 @@ namespace cu {
 	}
 
 	bool Parser::equality() {
-		if (!comparison()) return false;
+		if (!registerBinary(Precedence::EQUALITY) && !comparison()) return false;
 
 		while (peek().getType() == TokenType::EQU ||
 			   peek().getType() == TokenType::NEQ) {
@@ -437,7 +441,7 @@ namespace cu {
 	}
 
 	bool Parser::comparison() {
-		if (!term()) return false;
+		if (!registerBinary(Precedence::COMPARISON) && !term()) return false;
 
 		while (peek().getType() == TokenType::GRT 	||
 			   peek().getType() == TokenType::LST 	||
@@ -470,7 +474,7 @@ namespace cu {
 	}
 
 	bool Parser::term() {
-		if (!factor()) return false;
+		if (!registerBinary(Precedence::TERM) && !factor()) return false;
 
 		while (peek().getType() == TokenType::PLUS ||
 			   peek().getType() == TokenType::MINUS) {
@@ -495,7 +499,7 @@ namespace cu {
 	}
 
 	bool Parser::factor() {
-		if (!exponent()) return false;
+		if (!registerBinary(Precedence::FACTOR) && !exponent()) return false;
 
 		while (peek().getType() == TokenType::MULTIPLY 	||
 			   peek().getType() == TokenType::DIVIDE 	||
@@ -542,7 +546,7 @@ namespace cu {
 		switch (peek().getType()) {
 			case TokenType::PLUS_PLUS:
 			case TokenType::MINUS_MINUS: {
-				OpCode op = next().getType() == TokenType::PLUS_PLUS ? OpCode::INCR : OpCode::DECR;
+				OpCode op = next().getType() == TokenType::PLUS_PLUS ? OpCode::INCVAR : OpCode::DECVAR;
 
 				const auto& identifierToken = next();
 				auto stackIndex = env.resolveVariable(identifierToken.getLexeme());
@@ -557,9 +561,8 @@ namespace cu {
 					return false;
 				}
 
+				bytecode.emit(op, stackIndex, identifierToken.getLocation());
 				bytecode.emit(OpCode::LDVAR, stackIndex, identifierToken.getLocation());
-				bytecode.emit(op, identifierToken.getLocation());
-				bytecode.emit(OpCode::SETVAR, stackIndex, identifierToken.getLocation());
 
 				return true;
 			}
@@ -589,21 +592,27 @@ namespace cu {
 			case TokenType::OPEN_SQUARE_BRACKET:
 				if (!array()) return false;
 				break;
+			case TokenType::OPEN_BRACE:
+				if (!object()) return false;
+				break;
+			case TokenType::NEW:
+				if (!construct()) return false;
+				break;
 			case TokenType::NUMBER: {
-				auto const &constOffset = bytecode.addConstant(new NumberObject(primaryToken.getLexeme()));
+				auto const &constOffset = bytecode.addConstant(Value::number(std::stod(primaryToken.getLexeme())));
 				bytecode.emit(OpCode::LDC, constOffset, primaryToken.getLocation());
 				next();
 				break;
 			}
 			case TokenType::TRUE:
 			case TokenType::FALSE: {
-				auto const &constOffset = bytecode.addConstant(new BooleanObject(primaryToken.getLexeme()));
+				auto const &constOffset = bytecode.addConstant(Value::boolean(primaryToken.getType() == TokenType::TRUE));
 				bytecode.emit(OpCode::LDC, constOffset, primaryToken.getLocation());
 				next();
 				break;
 			}
 			case TokenType::STRING: {
-				auto const &constOffset = bytecode.addConstant(new StringObject(primaryToken.getLexeme()));
+				auto const &constOffset = bytecode.addConstant(Value::object(heap.intern(primaryToken.getLexeme())));
 				bytecode.emit(OpCode::LDC, constOffset, primaryToken.getLocation());
 				next();
 				break;
@@ -623,13 +632,13 @@ namespace cu {
 			case TokenType::IDENTIFIER:
 				return identifier();
 			case TokenType::NULL_TYPE: {
-				auto const &constOffset = bytecode.addConstant(new EmptyObject(ObjectType::NULL_TYPE));
+				auto const &constOffset = bytecode.addConstant(Value::null());
 				bytecode.emit(OpCode::LDC, constOffset, primaryToken.getLocation());
 				consume();
 				break;
 			}
 			case TokenType::UNDEFINED: {
-				auto const &constOffset = bytecode.addConstant(new EmptyObject(ObjectType::UNDEFINED));
+				auto const &constOffset = bytecode.addConstant(Value::undefined());
 				bytecode.emit(OpCode::LDC, constOffset, primaryToken.getLocation());
 				consume();
 				break;
@@ -649,7 +658,7 @@ namespace cu {
 					return false;
 				}
 
-				bytecode.emit(OpCode::JMP, loopStack.top().continueOffset, peek().getLocation());
+				bytecode.emitLoop(loopStack.top().continueOffset, peek().getLocation());
 				consume();
 				break;
 			case TokenType::EOF_TYPE:
@@ -685,7 +694,9 @@ namespace cu {
 		// so directly consume it here.
 		consume();
 
-		byte arraySize = 0;
+		if (constantArray()) return true;
+
+		size_t arraySize = 0;
 
 		while (!atEOF() && !match(TokenType::CLOSE_SQUARE_BRACKET)) {
 			if (!expression()) return false;
@@ -711,6 +722,189 @@ namespace cu {
 		return false;
 	}
 
+	/*
+		Compiles an array literal made only of constants, such as
+		["apples", "oranges"], to a template in the constant pool that
+		is cloned each time the literal is evaluated. Returns false,
+		without consuming anything, for any other array literal.
+	*/
+	bool Parser::constantArray() {
+		size_t end = curr;
+
+		for (;;) {
+			switch (tokens[end].getType()) {
+				case TokenType::NUMBER:
+				case TokenType::STRING:
+				case TokenType::TRUE:
+				case TokenType::FALSE:
+				case TokenType::NULL_TYPE:
+				case TokenType::UNDEFINED:
+					break;
+				default:
+					return false;
+			}
+
+			const auto nextType = tokens[++end].getType();
+			if (nextType == TokenType::COMMA && tokens[end + 1].getType() != TokenType::CLOSE_SQUARE_BRACKET) {
+				end++;
+				continue;
+			}
+
+			if (nextType == TokenType::COMMA) end++;
+			if (tokens[end].getType() == TokenType::CLOSE_SQUARE_BRACKET) break;
+
+			return false;
+		}
+
+		const auto location = peek().getLocation();
+		auto arrayTemplate = heap.allocateTenured<ArrayObject>();
+
+		for (; curr < end; curr++) {
+			const auto& token = tokens[curr];
+			Value element;
+
+			switch (token.getType()) {
+				case TokenType::NUMBER:
+					element = Value::number(std::stod(token.getLexeme()));
+					break;
+				case TokenType::STRING:
+					element = Value::object(heap.intern(token.getLexeme()));
+					break;
+				case TokenType::TRUE:
+				case TokenType::FALSE:
+					element = Value::boolean(token.getType() == TokenType::TRUE);
+					break;
+				case TokenType::NULL_TYPE:
+					element = Value::null();
+					break;
+				case TokenType::UNDEFINED:
+					element = Value::undefined();
+					break;
+				default:
+					// Commas
+					continue;
+			}
+
+			arrayTemplate->push(element);
+			heap.writeBarrier(arrayTemplate, arrayTemplate->length() - 1, element);
+		}
+
+		// The closing bracket
+		consume();
+
+		auto const &constOffset = bytecode.addConstant(Value::object(arrayTemplate));
+		bytecode.emit(OpCode::CLONEARR, constOffset, location);
+		return true;
+	}
+
+	bool Parser::object() {
+		// We have already checked for the opening brace '{',
+		// so directly consume it here.
+		consume();
+
+		size_t propertyCount = 0;
+
+		while (!atEOF() && !match(TokenType::CLOSE_BRACE)) {
+			const auto& keyToken = next();
+			std::string key;
+
+			switch (keyToken.getType()) {
+				case TokenType::IDENTIFIER:
+				case TokenType::STRING:
+					key = keyToken.getLexeme();
+					break;
+				case TokenType::NUMBER:
+					key = Value::numberToString(std::stod(keyToken.getLexeme()));
+					break;
+				default:
+					error("Expect property name");
+					return false;
+			}
+
+			auto const &keyOffset = bytecode.addConstant(Value::object(heap.intern(key)));
+			bytecode.emit(OpCode::LDC, keyOffset, keyToken.getLocation());
+
+			if (!match(TokenType::COLON)) {
+				error("Expect ':' after property name");
+				return false;
+			}
+
+			if (!expression()) return false;
+
+			if (++propertyCount > UINT8_MAX) {
+				error("Too many properties in object literal");
+				return false;
+			}
+
+			if (!match(TokenType::COMMA)) {
+				if (!match(TokenType::CLOSE_BRACE)) {
+					error("Expect ',' between object properties");
+					return false;
+				}
+
+				break;
+			}
+		}
+
+		if (previous().getType() == TokenType::CLOSE_BRACE) {
+			bytecode.emit(OpCode::NEWOBJ, propertyCount, peek().getLocation());
+			return true;
+		} else if (atEOF())
+			error("Unexpected end-of-file, expect '}'");
+		else
+			error("Expect '}' after object declaration");
+
+		return false;
+	}
+
+	bool Parser::construct() {
+		static const std::unordered_map<std::string, TypedArrayObject::ElementType> typedArrays = {
+			{ "Float64Array", TypedArrayObject::ElementType::FLOAT64 },
+			{ "Int32Array", TypedArrayObject::ElementType::INT32 },
+			{ "Uint8Array", TypedArrayObject::ElementType::UINT8 },
+		};
+
+		const auto& newToken = next();
+
+		if (!match(TokenType::IDENTIFIER)) {
+			error("Expect constructor name after 'new'");
+			return false;
+		}
+
+		const auto& name = previous().getLexeme();
+		const auto typedArray = typedArrays.find(name);
+		if (name != "Map" && name != "Set" && typedArray == typedArrays.end()) {
+			error("Unknown constructor: " + name);
+			return false;
+		}
+
+		if (!match(TokenType::OPEN_PAREN)) {
+			error("Expect '(' after constructor name");
+			return false;
+		}
+
+		// The only argument is an array of initial entries, or
+		// for typed arrays, a length, an array or a file path.
+		byte argCount = 0;
+		if (peek().getType() != TokenType::CLOSE_PAREN) {
+			if (!expression()) return false;
+			argCount = 1;
+		}
+
+		if (!match(TokenType::CLOSE_PAREN)) {
+			error("Expect ')' after constructor argument");
+			return false;
+		}
+
+		if (typedArray != typedArrays.end()) {
+			bytecode.emit(OpCode::NEWTYPED, static_cast<size_t>(typedArray->second), argCount, newToken.getLocation());
+		} else {
+			bytecode.emit(name == "Map" ? OpCode::NEWMAP : OpCode::NEWSET, argCount, newToken.getLocation());
+		}
+
+		return true;
+	}
+
 	bool Parser::stringTemplate() {
 		consume();	// the back tick `
 
@@ -745,7 +939,8 @@ namespace cu {
 		// TODO: Also pass the stack index of the identifierToken
 		// since it is recomputed in the functions called by
 		// both branches.
-		if (peek().getType() == TokenType::OPEN_SQUARE_BRACKET) {
+		const auto nextType = peek().getType();
+		if (nextType == TokenType::OPEN_SQUARE_BRACKET || nextType == TokenType::DOT) {
 			return memberAccess(identifierToken);
 		} else {
 			return variableReference(identifierToken);
@@ -756,27 +951,71 @@ namespace cu {
 		auto stackIndex = env.resolveVariable(identifierToken.getLexeme());
 		bytecode.emit(OpCode::LDVAR, stackIndex, identifierToken.getLocation());
 
-		while (match(TokenType::OPEN_SQUARE_BRACKET)) {
-			if (!expression()) return false;
-			
-			if (!match(TokenType::CLOSE_SQUARE_BRACKET)) {
-				error("Expect ']' after member access");
-				return false;
+		for (;;) {
+			if (match(TokenType::OPEN_SQUARE_BRACKET)) {
+				if (!expression()) return false;
+
+				if (!match(TokenType::CLOSE_SQUARE_BRACKET)) {
+					error("Expect ']' after member access");
+					return false;
+				}
+			} else if (match(TokenType::DOT)) {
+				if (!match(TokenType::IDENTIFIER)) {
+					error("Expect property name after '.'");
+					return false;
+				}
+
+				const auto& nameToken = previous();
+				auto nameOffset = bytecode.addConstant(Value::object(heap.intern(nameToken.getLexeme())));
+
+				if (match(TokenType::OPEN_PAREN)) {
+					if (!methodCall(nameToken, nameOffset)) return false;
+					continue;
+				}
+
+				bytecode.emit(OpCode::LDC, nameOffset, nameToken.getLocation());
+			} else {
+				break;
 			}
 
 			if (!match(TokenType::ASSIGNMENT)) {
-				bytecode.emit(OpCode::LDPROP, previous().getLocation());
+				bytecode.emit(OpCode::LDPROP, bytecode.addPropertyCache(), previous().getLocation());
+			} else {
+				break;
 			}
 		}
 		
 		if (previous().getType() == TokenType::ASSIGNMENT) {
 			if (!expression()) return false;
-			bytecode.emit(OpCode::SETPROP, peek().getLocation());
+			bytecode.emit(OpCode::SETPROP, bytecode.addPropertyCache(), peek().getLocation());
 		}
 
 		return true;
 	}
 
+	// Called after the opening parenthesis, with the receiver on the stack.
+	bool Parser::methodCall(const Token& nameToken, const size_t nameOffset) {
+		size_t argCount = 0;
+
+		if (!match(TokenType::CLOSE_PAREN)) {
+			do {
+				if (!expression()) return false;
+				if (++argCount > UINT8_MAX) {
+					error("Too many arguments");
+					return false;
+				}
+			} while (match(TokenType::COMMA));
+
+			if (!match(TokenType::CLOSE_PAREN)) {
+				error("Expect ')' after arguments");
+				return false;
+			}
+		}
+
+		bytecode.emit(OpCode::INVOKE, nameOffset, argCount, nameToken.getLocation());
+		return true;
+	}
+
 	bool Parser::variableReference(const Token& identifierToken) {
 		auto stackIndex = env.resolveVariable(identifierToken.getLexeme());
 		if (match(TokenType::ASSIGNMENT)) {
@@ -803,39 +1042,110 @@ namespace cu {
 			return false;
 		}
 
-		/*
-			Pushing the value twice on the stack because we need to make two states of this variable
-			- pre-increment value
-			- prepare the new incremented/decremented value that would then be assigned to the original
-				via SETVAR and then be popped off
-		*/
-		bytecode.emit(OpCode::LDVAR, stackIndex, identifierToken.getLocation());
+		// The value before the update is the result
 		bytecode.emit(OpCode::LDVAR, stackIndex, identifierToken.getLocation());
 
-		/*
-			We don't use the INCR/DECR instructions because they operate on the object at the top of
-			the stack. When we push the target value on the stack using LDVAR as above, it is
-			a reference to the original value. Thus, any increment/decrement will affect all such
-			references, including the pre-increment value which should preserve the original value.
+		OpCode op = previous().getType() == TokenType::PLUS_PLUS ? OpCode::INCVAR : OpCode::DECVAR;
+		bytecode.emit(op, stackIndex, previous().getLocation());
 
-			Thus, we need to produce a new value on the stack and not just increment this copy. Thus,
-			we push 1 on the stack, perform ADD/SUB which then pushes a new result value onto the stack,
-			without affecting the pre-increment copy.
+		return true;
+	}
 
-			We then set this new value to the original using SETVAR and pop it off so that the pre-increment
-			value remains at the top of the stack as would be expected as the result of this expression.
-		*/
-		auto constOffset = bytecode.addConstant(new NumberObject(1));
-		bytecode.emit(OpCode::LDC, constOffset, previous().getLocation());
-		OpCode op = previous().getType() == TokenType::PLUS_PLUS ? OpCode::ADD : OpCode::SUB;
-		bytecode.emit(op, previous().getLocation());
+	Parser::Precedence Parser::precedence(const TokenType type) {
+		switch (type) {
+			case TokenType::EQU:
+			case TokenType::NEQ:
+				return Precedence::EQUALITY;
+			case TokenType::GRT:
+			case TokenType::LST:
+			case TokenType::GRE:
+			case TokenType::LSE:
+				return Precedence::COMPARISON;
+			case TokenType::PLUS:
+			case TokenType::MINUS:
+				return Precedence::TERM;
+			case TokenType::MULTIPLY:
+			case TokenType::DIVIDE:
+			case TokenType::MODULO:
+				return Precedence::FACTOR;
+			case TokenType::EXPONENT:
+				return Precedence::EXPONENT;
+			default:
+				return Precedence::NONE;
+		}
+	}
 
-		bytecode.emit(OpCode::SETVAR, stackIndex, previous().getLocation());
-		bytecode.emit(OpCode::POP, previous().getLocation());
+	// Whether an operand of an operator of the given precedence ends before this token.
+	bool Parser::endsOperand(const TokenType type, const Precedence level) {
+		const auto typePrecedence = precedence(type);
+		if (typePrecedence != Precedence::NONE) return typePrecedence <= level;
+
+		switch (type) {
+			case TokenType::AND:
+			case TokenType::OR:
+			case TokenType::SEMICOLON:
+			case TokenType::COLON:
+			case TokenType::COMMA:
+			case TokenType::CLOSE_PAREN:
+			case TokenType::CLOSE_SQUARE_BRACKET:
+			case TokenType::CLOSE_BRACE:
+			case TokenType::EOF_TYPE:
+				return true;
+			default:
+				return false;
+		}
+	}
 
+	bool Parser::registerBinary(const Precedence level) {
+		static const std::unordered_map<TokenType, OpCode> registerOps = {
+			{ TokenType::EQU, OpCode::EQUR },
+			{ TokenType::NEQ, OpCode::NEQR },
+			{ TokenType::GRT, OpCode::GRTR },
+			{ TokenType::LST, OpCode::LSTR },
+			{ TokenType::GRE, OpCode::GRER },
+			{ TokenType::LSE, OpCode::LSER },
+			{ TokenType::PLUS, OpCode::ADDR },
+			{ TokenType::MINUS, OpCode::SUBR },
+			{ TokenType::MULTIPLY, OpCode::MULR },
+			{ TokenType::DIVIDE, OpCode::DIVR },
+			{ TokenType::MODULO, OpCode::MODR },
+		};
+
+		// Operand, operator, operand, and whatever follows them
+		if (curr + 3 >= tokens.size()) return false;
+
+		const auto& operatorToken = tokens[curr + 1];
+		if (precedence(operatorToken.getType()) != level) return false;
+		if (!endsOperand(tokens[curr + 3].getType(), level)) return false;
+
+		const auto left = registerOperand(tokens[curr]);
+		if (left == -1) return false;
+
+		const auto right = registerOperand(tokens[curr + 2]);
+		if (right == -1) return false;
+
+		const auto op = registerOps.at(operatorToken.getType());
+		bytecode.emit(op, left, static_cast<byte>(right), operatorToken.getLocation());
+
+		curr += 3;
 		return true;
 	}
 
+	// Returns -1 if the token is neither a variable nor a number that fits in an operand.
+	int Parser::registerOperand(const Token& token) {
+		if (token.getType() == TokenType::IDENTIFIER) {
+			const auto stackIndex = env.resolveVariable(token.getLexeme());
+			return stackIndex < REGISTER_CONSTANT ? stackIndex : -1;
+		}
+
+		if (token.getType() == TokenType::NUMBER) {
+			const auto constOffset = bytecode.addConstant(Value::number(std::stod(token.getLexeme())));
+			return constOffset < REGISTER_CONSTANT ? REGISTER_CONSTANT + constOffset : -1;
+		}
+
+		return -1;
+	}
+
 	void Parser::error(const std::string& msg) const {
 		const Token& currentToken = peek();
 
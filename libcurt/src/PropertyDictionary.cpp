@@ -0,0 +1,132 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Object.h"
+#include "PropertyDictionary.h"
+
+namespace cu {
+
+	constexpr int8_t PropertyDictionary::EMPTY;
+	constexpr size_t PropertyDictionary::GROUP_WIDTH;
+	constexpr size_t PropertyDictionary::INITIAL_CAPACITY;
+	constexpr size_t PropertyDictionary::MAX_LOAD;
+	constexpr size_t PropertyDictionary::NOT_FOUND;
+
+	// Bit i is set if control byte i of the group equals the byte.
+	static inline uint32_t matchGroup(const int8_t* group, const int8_t byte) {
+#if defined(__SSE2__)
+		const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(byte)));
+#else
+		uint32_t mask = 0;
+		for (uint32_t i = 0; i < 16; i++) {
+			if (group[i] == byte) mask |= 1u << i;
+		}
+
+		return mask;
+#endif
+	}
+
+	// The low 7 bits of a hash go in the control bytes, the rest
+	// select the group where probing starts.
+	static inline int8_t controlByte(const uint64_t hash) { return hash & 0x7f; }
+	static inline size_t firstGroup(const uint64_t hash) { return hash >> 7; }
+
+	const Value* PropertyDictionary::find(const StringObject* key) const {
+		const auto index = indexOf(key, key->hashCode());
+		return index != NOT_FOUND ? &entries[index].value : nullptr;
+	}
+
+	void PropertyDictionary::set(const StringObject* key, const Value& value) {
+		const auto hash = key->hashCode();
+
+		const auto index = indexOf(key, hash);
+		if (index != NOT_FOUND) {
+			entries[index].value = value;
+			return;
+		}
+
+		if ((entries.size() + 1) * 100 > control.size() * MAX_LOAD) {
+			rehash(control.empty() ? INITIAL_CAPACITY : control.size() * 2);
+		}
+
+		entries.push_back({ key, value });
+		place(hash, entries.size() - 1);
+	}
+
+	size_t PropertyDictionary::footprint() const {
+		return entries.capacity() * sizeof(Entry) + control.size() * (sizeof(int8_t) + sizeof(uint32_t));
+	}
+
+	/*
+		Groups are probed in triangular order, which visits every group
+		since their count is a power of two. The table always has empty
+		slots, so a miss ends at the first group with one.
+	*/
+	size_t PropertyDictionary::indexOf(const StringObject* key, const uint64_t hash) const {
+		if (control.empty()) return NOT_FOUND;
+
+		const size_t mask = control.size() / GROUP_WIDTH - 1;
+		const int8_t byte = controlByte(hash);
+
+		size_t group = firstGroup(hash) & mask;
+		for (size_t step = 1; ; step++) {
+			const auto base = group * GROUP_WIDTH;
+
+			for (auto matches = matchGroup(&control[base], byte); matches != 0; matches &= matches - 1) {
+				const auto index = slots[base + __builtin_ctz(matches)];
+				if (entries[index].key == key) return index;
+			}
+
+			if (matchGroup(&control[base], EMPTY) != 0) return NOT_FOUND;
+
+			group = (group + step) & mask;
+		}
+	}
+
+	void PropertyDictionary::place(const uint64_t hash, const uint32_t index) {
+		const size_t mask = control.size() / GROUP_WIDTH - 1;
+
+		size_t group = firstGroup(hash) & mask;
+		for (size_t step = 1; ; step++) {
+			const auto base = group * GROUP_WIDTH;
+
+			const auto empty = matchGroup(&control[base], EMPTY);
+			if (empty != 0) {
+				const auto slot = base + __builtin_ctz(empty);
+				control[slot] = controlByte(hash);
+				slots[slot] = index;
+				return;
+			}
+
+			group = (group + step) & mask;
+		}
+	}
+
+	void PropertyDictionary::rehash(const size_t capacity) {
+		control.assign(capacity, EMPTY);
+		slots.assign(capacity, 0);
+
+		for (uint32_t index = 0; index < entries.size(); index++) {
+			place(entries[index].key->hashCode(), index);
+		}
+	}
+
+} // namespace cu
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+
+#include "Heap.h"
+#include "PropertyKey.h"
+
+namespace cu {
+
+	bool PropertyKey::toIndex(const double number, uint32_t& index) {
+		if (number >= 0 && number < UINT32_MAX && number == std::trunc(number)) {
+			index = static_cast<uint32_t>(number);
+			return true;
+		}
+
+		return false;
+	}
+
+	PropertyKey PropertyKey::from(const Value& property, Heap& heap) {
+		uint32_t index;
+
+		switch (property.type()) {
+			case ObjectType::NUMBER:
+				if (toIndex(property.asNumber(), index)) return PropertyKey(index);
+				break;
+			case ObjectType::STRING: {
+				const auto str = property.asString();
+				if (str->isInterned()) {
+					return str->isArrayIndex() ? PropertyKey(str->arrayIndex(), str) : PropertyKey(str);
+				}
+
+				if (StringObject::parseArrayIndex(str->units(), str->isTwoByte(), index)) {
+					return PropertyKey(index);
+				}
+
+				return PropertyKey(heap.intern(*str));
+			}
+			case ObjectType::ARRAY: {
+				/*
+					Emulating the following JS behaviour:
+
+					let arr = [1, 2, 3];
+					arr[[1]] -> 2
+				*/
+				const auto arr = property.asArray();
+				if (arr->length() == 1) return from((*arr)[0], heap);
+				break;
+			}
+			default:
+				break;
+		}
+
+		return PropertyKey(heap.intern(property.toString()));
+	}
+
+	PropertyKey PropertyKey::find(const Value& property, const Heap& heap) {
+		uint32_t index;
+
+		switch (property.type()) {
+			case ObjectType::NUMBER:
+				if (toIndex(property.asNumber(), index)) return PropertyKey(index);
+				break;
+			case ObjectType::STRING: {
+				const auto str = property.asString();
+				if (str->isInterned()) {
+					return str->isArrayIndex() ? PropertyKey(str->arrayIndex(), str) : PropertyKey(str);
+				}
+
+				if (StringObject::parseArrayIndex(str->units(), str->isTwoByte(), index)) {
+					return PropertyKey(index);
+				}
+
+				return PropertyKey(heap.findInterned(*str));
+			}
+			case ObjectType::ARRAY: {
+				const auto arr = property.asArray();
+				if (arr->length() == 1) return find((*arr)[0], heap);
+				break;
+			}
+			default:
+				break;
+		}
+
+		return PropertyKey(heap.findInterned(property.toString()));
+	}
+
+	StringObject* PropertyKey::toName(Heap& heap) const {
+		if (name != nullptr || !indexed) return name;
+		return heap.intern(Value::numberToString(index));
+	}
+
+	StringObject* PropertyKey::findName(const Heap& heap) const {
+		if (name != nullptr || !indexed) return name;
+		return heap.findInterned(Value::numberToString(index));
+	}
+
+} // namespace cu
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "RawBuffer.h"
+
+namespace cu {
+
+	RawBuffer::RawBuffer(RawBuffer&& other)
+		: bytes(other.bytes), length(other.length), mapped(other.mapped) {
+		other.bytes = nullptr;
+		other.length = 0;
+		other.mapped = false;
+	}
+
+	RawBuffer& RawBuffer::operator=(RawBuffer&& other) {
+		if (this != &other) {
+			release();
+			std::swap(bytes, other.bytes);
+			std::swap(length, other.length);
+			std::swap(mapped, other.mapped);
+		}
+
+		return *this;
+	}
+
+	RawBuffer RawBuffer::allocate(const size_t size) {
+		RawBuffer buffer;
+		if (size == 0) return buffer;
+
+		buffer.bytes = new uint8_t[size]();
+		buffer.length = size;
+		return buffer;
+	}
+
+#if defined(_WIN32)
+	// Without mmap, the file is read into memory instead.
+	bool RawBuffer::map(const std::string& path, RawBuffer& buffer, std::string& error) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) {
+			error = "Could not open file: " + path;
+			return false;
+		}
+
+		buffer = allocate(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+
+		if (!file.read(reinterpret_cast<char*>(buffer.bytes), buffer.length)) {
+			error = "Could not read file: " + path;
+			return false;
+		}
+
+		return true;
+	}
+#else
+	bool RawBuffer::map(const std::string& path, RawBuffer& buffer, std::string& error) {
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			error = "Could not open file: " + path;
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			close(fd);
+			error = "Could not read file: " + path;
+			return false;
+		}
+
+		// mmap() rejects empty mappings.
+		if (info.st_size == 0) {
+			close(fd);
+			buffer = RawBuffer();
+			return true;
+		}
+
+		const size_t size = static_cast<size_t>(info.st_size);
+		void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+		// The mapping stays valid after the descriptor is closed.
+		close(fd);
+
+		if (memory == MAP_FAILED) {
+			error = "Could not map file: " + path;
+			return false;
+		}
+
+		buffer = RawBuffer();
+		buffer.bytes = static_cast<uint8_t*>(memory);
+		buffer.length = size;
+		buffer.mapped = true;
+		return true;
+	}
+#endif
+
+	void RawBuffer::release() {
+		if (bytes == nullptr) return;
+
+#if !defined(_WIN32)
+		if (mapped) {
+			munmap(bytes, length);
+			bytes = nullptr;
+			return;
+		}
+#endif
+
+		delete[] bytes;
+		bytes = nullptr;
+	}
+
+} // namespace cu
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Shape.h"
+
+namespace cu {
+
+	constexpr size_t Shape::NOT_FOUND;
+	constexpr size_t Shape::MAX_LINEAR_LOOKUP;
+
+	Shape::Shape(Shape* parent, StringObject* key)
+		: Object(ObjectType::SHAPE), parent(parent), keys(parent->keys) {
+		keys.push_back(key);
+
+		if (keys.size() > MAX_LINEAR_LOOKUP) {
+			for (size_t slot = 0; slot < keys.size(); slot++) {
+				index[keys[slot]] = slot;
+			}
+		}
+	}
+
+	std::string Shape::toString() const {
+		return "[shape of " + std::to_string(keys.size()) + " keys]";
+	}
+
+	void Shape::trace(Tracer& tracer) {
+		// The other keys are traced by the ancestors of this shape.
+		// Both shapes and interned strings are tenured and never
+		// move, so visiting copies is enough.
+		if (parent != nullptr) {
+			Value parentShape = Value::object(parent);
+			tracer.visit(parentShape);
+
+			Value key = Value::object(keys.back());
+			tracer.visit(key);
+		}
+	}
+
+	size_t Shape::footprint() const {
+		const size_t indexSize = index.size() * (sizeof(void*) + sizeof(std::pair<const StringObject*, size_t>));
+		return sizeof(Shape) + keys.capacity() * sizeof(StringObject*) + indexSize;
+	}
+
+	size_t Shape::lookup(const StringObject* key) const {
+		if (keys.size() > MAX_LINEAR_LOOKUP) {
+			const auto itr = index.find(key);
+			return itr != index.end() ? itr->second : NOT_FOUND;
+		}
+
+		for (size_t slot = 0; slot < keys.size(); slot++) {
+			if (keys[slot] == key) return slot;
+		}
+
+		return NOT_FOUND;
+	}
+
+} // namespace cu
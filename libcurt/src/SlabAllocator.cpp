@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <new>
+
+#include "SlabAllocator.h"
+
+namespace cu {
+
+	constexpr size_t SlabAllocator::GRANULE;
+	constexpr size_t SlabAllocator::MAX_CELL_SIZE;
+	constexpr size_t SlabAllocator::SLAB_SIZE;
+	constexpr size_t SlabAllocator::SIZE_CLASS_COUNT;
+
+	SlabAllocator::~SlabAllocator() {
+		for (const auto& sizeClass : sizeClasses) {
+			for (char* slab : sizeClass.slabs) {
+				::operator delete(slab);
+			}
+		}
+	}
+
+	void* SlabAllocator::allocate(const size_t size) {
+		if (size > MAX_CELL_SIZE) {
+			largeObjects++;
+			largeBytes += size;
+			return ::operator new(size);
+		}
+
+		const auto index = sizeClassIndex(size);
+		auto& sizeClass = sizeClasses[index];
+		sizeClass.liveCells++;
+
+		if (sizeClass.freeList != nullptr) {
+			FreeCell* cell = sizeClass.freeList;
+			sizeClass.freeList = cell->next;
+			return cell;
+		}
+
+		const auto cell = cellSize(index);
+		if (sizeClass.cursor == nullptr || sizeClass.cursor + cell > sizeClass.end) {
+			char* slab = static_cast<char*>(::operator new(SLAB_SIZE));
+			sizeClass.slabs.push_back(slab);
+			sizeClass.cursor = slab;
+			sizeClass.end = slab + SLAB_SIZE;
+		}
+
+		void* memory = sizeClass.cursor;
+		sizeClass.cursor += cell;
+		return memory;
+	}
+
+	void SlabAllocator::free(void* memory, const size_t size) {
+		if (size > MAX_CELL_SIZE) {
+			largeObjects--;
+			largeBytes -= size;
+			::operator delete(memory);
+			return;
+		}
+
+		auto& sizeClass = sizeClasses[sizeClassIndex(size)];
+		sizeClass.liveCells--;
+
+		FreeCell* cell = static_cast<FreeCell*>(memory);
+		cell->next = sizeClass.freeList;
+		sizeClass.freeList = cell;
+	}
+
+	void SlabAllocator::printStats(std::ostream& stream) const {
+		for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+			const auto& sizeClass = sizeClasses[i];
+			if (sizeClass.slabs.empty()) continue;
+
+			stream << "heap: " << cellSize(i) << "-byte class: " << sizeClass.liveCells << " live objects, ";
+			stream << sizeClass.liveCells * cellSize(i) << " bytes in " << sizeClass.slabs.size();
+			stream << " slabs (" << sizeClass.slabs.size() * SLAB_SIZE / 1024 << " KB)" << std::endl;
+		}
+
+		if (largeObjects != 0) {
+			stream << "heap: large objects: " << largeObjects << " live objects, " << largeBytes << " bytes" << std::endl;
+		}
+	}
+
+} // namespace cu
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StringTable.h"
+
+namespace cu {
+
+	constexpr size_t StringTable::INITIAL_CAPACITY;
+	constexpr size_t StringTable::MAX_LOAD;
+
+	StringObject* StringTable::find(const StringUnits& units, const bool twoByte, const uint64_t hash) const {
+		if (entries.empty()) return nullptr;
+
+		const size_t mask = entries.size() - 1;
+		for (size_t i = hash & mask; entries[i] != nullptr; i = (i + 1) & mask) {
+			StringObject* entry = entries[i];
+			if (entry->hashCode() == hash && entry->isTwoByte() == twoByte && entry->units() == units) {
+				return entry;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void StringTable::insert(StringObject* str) {
+		if ((count + 1) * 100 > entries.size() * MAX_LOAD) {
+			rehash(entries.empty() ? INITIAL_CAPACITY : entries.size() * 2);
+		}
+
+		place(str);
+		count++;
+	}
+
+	void StringTable::removeIf(const std::function<bool(const StringObject*)>& predicate) {
+		std::vector<StringObject*> old;
+		old.swap(entries);
+		entries.resize(old.size(), nullptr);
+		count = 0;
+
+		for (StringObject* entry : old) {
+			if (entry != nullptr && !predicate(entry)) {
+				place(entry);
+				count++;
+			}
+		}
+	}
+
+	void StringTable::rehash(const size_t capacity) {
+		std::vector<StringObject*> old;
+		old.swap(entries);
+		entries.resize(capacity, nullptr);
+
+		for (StringObject* entry : old) {
+			if (entry != nullptr) place(entry);
+		}
+	}
+
+	void StringTable::place(StringObject* str) {
+		const size_t mask = entries.size() - 1;
+
+		size_t i = str->hashCode() & mask;
+		while (entries[i] != nullptr) {
+			i = (i + 1) & mask;
+		}
+
+		entries[i] = str;
+	}
+
+} // namespace cu
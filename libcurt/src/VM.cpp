@@ -15,29 +15,55 @@
  */
 
 #include <iostream>
-#include <memory>
 
 #include "Colors.h"
+#include "Natives.h"
 #include "Object.h"
 #include "VM.h"
 
+/*
+    Threaded dispatch relies on labels as values, which GCC and Clang
+    support as an extension. Configure with CU_THREADED_DISPATCH=OFF
+    to fall back to the portable switch.
+*/
+#if defined(__GNUC__) && !defined(CU_SWITCH_DISPATCH)
+#define THREADED_DISPATCH
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+// Caching the top of the stack builds on threaded dispatch
+#if defined(THREADED_DISPATCH) && defined(CU_STACK_CACHING)
+#define STACK_CACHING
+#endif
+
 namespace cu {
 
-    static bool isTruthy(const std::shared_ptr<Object>& obj) {
-        switch (obj->type) {
-            case ObjectType::BOOLEAN:
-                return std::dynamic_pointer_cast<BooleanObject>(obj)->get();
-            case ObjectType::NUMBER:
-                return std::dynamic_pointer_cast<NumberObject>(obj)->get() != 0;
-            case ObjectType::STRING:
-                return std::dynamic_pointer_cast<StringObject>(obj)->get().length() != 0;
-            case ObjectType::NULL_TYPE:
-            case ObjectType::UNDEFINED:
-                return false;
+    /*
+        Joins two values of which at least one is a string. Short results
+        are copied, longer ones become a rope that shares both operands.
+    */
+    Value VM::concatenate(const Value& left, const Value& right) {
+        const auto toStringValue = [this](const Value& value) {
+            return value.isString() ? value : Value::object(heap.allocate<StringObject>(value.toString()));
+        };
+
+        const auto first = toStringValue(left), second = toStringValue(right);
+        const auto firstStr = first.asString(), secondStr = second.asString();
+
+        auto rope = heap.allocate<StringObject>(first, second);
+        if (firstStr->length() + secondStr->length() < StringObject::MIN_ROPE_LENGTH) {
+            rope->flatten();
+            return Value::object(rope);
         }
+
+        // The rope may have been tenured while its halves are young.
+        heap.writeBarrier(rope, first);
+        heap.writeBarrier(rope, second);
+
+        return Value::object(rope);
     }
 
-    void VM::error(const TranslationUnit& translationUnit, const Bytecode& bytecode, const std::string& msg) const {
+    void VM::error(const TranslationUnit& translationUnit, const Bytecode& bytecode, const size_t ip, const std::string& msg) const {
         std::cout << ANSICodes::RED << ANSICodes::BOLD << "error: " << ANSICodes::RESET;
         std::cout << ANSICodes::BOLD << translationUnit.filepath << ANSICodes::RESET << " ";
         
@@ -51,156 +77,439 @@ namespace cu {
         std::cout << ANSICodes::RED << ANSICodes::BOLD << "↑" << ANSICodes::RESET << std::endl;
     }
 
+    /*
+        Only properties named by interned strings are cached, since the
+        caches compare keys by address. Names written as .name or as
+        string literals are always interned.
+    */
+    static bool isCacheable(const PropertyCache& cache, const Shape* shape, const Value& property) {
+        return shape != nullptr && !cache.isMegamorphic() && property.isString() && property.asString()->isInterned();
+    }
+
+    static void cacheLoad(PropertyCache& cache, const PlainObject& obj, const Value& property) {
+        const auto shape = obj.getShape();
+        if (!isCacheable(cache, shape, property)) return;
+
+        const auto key = property.asString();
+        const auto slot = shape->lookup(key);
+        if (slot != Shape::NOT_FOUND) {
+            cache.add({ shape, key, slot, nullptr });
+        }
+    }
+
+    // Shape is the shape that the object had before the property was set.
+    static void cacheStore(PropertyCache& cache, Shape* shape, const PlainObject& obj, const Value& property) {
+        if (!isCacheable(cache, shape, property) || obj.getShape() == nullptr) return;
+
+        const auto key = property.asString();
+        if (obj.getShape() == shape) {
+            cache.add({ shape, key, shape->lookup(key), nullptr });
+        } else {
+            cache.add({ shape, key, shape->propertyCount(), obj.getShape() });
+        }
+    }
+
+    /*
+        Roots are everything the running program can still reach:
+        the stack, which also holds the REPL's globals from previous
+        runs, and the constant pool of the bytecode being executed.
+    */
+    void VM::collectGarbage(const Bytecode& bytecode) {
+        heap.collect([&](Tracer& tracer) {
+            for (auto& value : stack) {
+                tracer.visit(value);
+            }
+
+            // Constants are tenured, so the collector never moves them
+            // and visiting a copy of each is enough.
+            for (auto constant : bytecode.constants) {
+                tracer.visit(constant);
+            }
+
+            for (const auto& cache : bytecode.propertyCaches) {
+                cache.trace(tracer);
+            }
+        });
+    }
+
     int VM::run(const Bytecode& bytecode, const TranslationUnit& translationUnit) {
 
-#define BINARY_OP(op, ResultObjectType)                                              \
-    do                                                                               \
-    {                                                                                \
-        auto rightVal = stack.top();                                                 \
-        if (rightVal->type != ObjectType::NUMBER)                                    \
-        {                                                                            \
-            error(translationUnit, bytecode, "Operand must be a number.");           \
-            return 1;                                                                \
-        }                                                                            \
-        stack.pop();                                                                 \
-                                                                                     \
-        auto leftVal = stack.top();                                                  \
-        if (leftVal->type != ObjectType::NUMBER)                                     \
-        {                                                                            \
-            error(translationUnit, bytecode, "Operand must be a number.");           \
-            return 1;                                                                \
-        }                                                                            \
-        stack.pop();                                                                 \
-                                                                                     \
-        auto left = std::dynamic_pointer_cast<NumberObject>(leftVal);                \
-        auto right = std::dynamic_pointer_cast<NumberObject>(rightVal);              \
-        stack.push(std::make_shared<ResultObjectType>(left->get() op right->get())); \
+#define BINARY_OP(op, makeResult)                                             \
+    do                                                                        \
+    {                                                                         \
+        auto rightVal = stack.top();                                          \
+        if (!rightVal.isNumber())                                             \
+        {                                                                     \
+            error(translationUnit, bytecode, ip, "Operand must be a number."); \
+            return 1;                                                         \
+        }                                                                     \
+        stack.pop();                                                          \
+                                                                              \
+        auto leftVal = stack.top();                                           \
+        if (!leftVal.isNumber())                                              \
+        {                                                                     \
+            error(translationUnit, bytecode, ip, "Operand must be a number."); \
+            return 1;                                                         \
+        }                                                                     \
+        stack.pop();                                                          \
+                                                                              \
+        stack.push(makeResult(leftVal.asNumber() op rightVal.asNumber()));    \
     } while (false)
 
-#define EQUALITY_OP(op)                                                                   \
-    do                                                                                    \
-    {                                                                                     \
-        auto rightVal = stack.top();                                                      \
-        stack.pop();                                                                      \
-        auto leftVal = stack.top();                                                       \
-        stack.pop();                                                                      \
-                                                                                          \
-        if (leftVal->type != rightVal->type)                                              \
-            stack.push(std::make_shared<BooleanObject>(leftVal->type op rightVal->type)); \
-        else if (leftVal->type == ObjectType::BOOLEAN)                                    \
-        {                                                                                 \
-            auto left = std::dynamic_pointer_cast<BooleanObject>(leftVal);                \
-            auto right = std::dynamic_pointer_cast<BooleanObject>(rightVal);              \
-            stack.push(std::make_shared<BooleanObject>(left->get() op right->get()));     \
-        }                                                                                 \
-        else if (leftVal->type == ObjectType::NUMBER)                                     \
-        {                                                                                 \
-            auto left = std::dynamic_pointer_cast<NumberObject>(leftVal);                 \
-            auto right = std::dynamic_pointer_cast<NumberObject>(rightVal);               \
-            stack.push(std::make_shared<BooleanObject>(left->get() op right->get()));     \
-        }                                                                                 \
-        else if (leftVal->type == ObjectType::STRING)                                     \
-        {                                                                                 \
-            auto left = std::dynamic_pointer_cast<StringObject>(leftVal);                 \
-            auto right = std::dynamic_pointer_cast<StringObject>(rightVal);               \
-            stack.push(std::make_shared<BooleanObject>(left->get() op right->get()));     \
-        }                                                                                 \
+#define BINARY_LOGICAL_OP(op)                                                 \
+    do                                                                        \
+    {                                                                         \
+        auto rightVal = stack.top();                                          \
+        if (!rightVal.isBoolean())                                            \
+        {                                                                     \
+            error(translationUnit, bytecode, ip, "Operand must be a boolean."); \
+            return 1;                                                         \
+        }                                                                     \
+        stack.pop();                                                          \
+                                                                              \
+        auto leftVal = stack.top();                                           \
+        if (!leftVal.isBoolean())                                             \
+        {                                                                     \
+            error(translationUnit, bytecode, ip, "Operand must be a boolean."); \
+            return 1;                                                         \
+        }                                                                     \
+        stack.pop();                                                          \
+                                                                              \
+        stack.push(Value::boolean(leftVal.asBoolean() op rightVal.asBoolean())); \
     } while (false)
 
-#define BINARY_LOGICAL_OP(op)                                                    \
-    do                                                                           \
-    {                                                                            \
-        auto rightVal = stack.top();                                             \
-        if (rightVal->type != ObjectType::BOOLEAN)                               \
-        {                                                                        \
-            error(translationUnit, bytecode, "Operand must be a boolean.");      \
-            return 1;                                                            \
-        }                                                                        \
-        stack.pop();                                                             \
-                                                                                 \
-        auto leftVal = stack.top();                                              \
-        if (leftVal->type != ObjectType::BOOLEAN)                                \
-        {                                                                        \
-            error(translationUnit, bytecode, "Operand must be a boolean.");      \
-            return 1;                                                            \
-        }                                                                        \
-        stack.pop();                                                             \
-                                                                                 \
-        auto left = std::dynamic_pointer_cast<BooleanObject>(leftVal);           \
-        auto right = std::dynamic_pointer_cast<BooleanObject>(rightVal);         \
-        stack.push(std::make_shared<BooleanObject>(left->get() op right->get())); \
+/*
+    Register operations read their operands in place, from variables
+    or from the constant pool, without touching the stack.
+*/
+#define READ_REGISTER()                                                     \
+    (code[++ip] >= REGISTER_CONSTANT                                         \
+        ? bytecode.constants[code[ip] - REGISTER_CONSTANT]                   \
+        : stack[code[ip]])
+
+#define REGISTER_OP(op, makeResult)                                         \
+    do                                                                      \
+    {                                                                       \
+        const auto leftVal = READ_REGISTER();                               \
+        const auto rightVal = READ_REGISTER();                              \
+        if (!leftVal.isNumber() || !rightVal.isNumber())                    \
+        {                                                                   \
+            error(translationUnit, bytecode, ip, "Operand must be a number."); \
+            return 1;                                                       \
+        }                                                                   \
+                                                                            \
+        PUSH_RESULT(makeResult(leftVal.asNumber() op rightVal.asNumber())); \
     } while (false)
 
 /*
     The constant is stored in the constant pool of the bytecode.
     We need to fetch the constant at the index indicated by
     the operand of LDC. Thus, we increment the instruction pointer
-    to fetch Object at the constant offset in the pool.
+    to fetch the Value at the constant offset in the pool.
 */
-#define GET_CONST() (bytecode.constants[code[++ip]])
-
-#define GET_STRING() std::dynamic_pointer_cast<StringObject>(GET_CONST())
+#define GET_CONST() (bytecode.constants[READ_OPERAND()])
 
-#define READ_OPERAND() code[++ip]
+/*
+    Operands are a byte each, unless a WIDE prefix preceded the
+    instruction, in which case its first operand is four bytes.
+*/
+#define READ_OPERAND()                                                      \
+    (wide ? (wide = false, ip += 4, Bytecode::readWord(&code[ip - 3]))      \
+          : code[++ip])
 
-        auto const& code = bytecode.blob;
+#define READ_JUMP()                                                         \
+    (wide ? (wide = false, ip += 4, Bytecode::readWord(&code[ip - 3]))      \
+          : (ip += 2, Bytecode::readShort(&code[ip - 1])))
 
-        for (ip = 0; ip < code.size(); ip++) {
+/*
+    Instructions that allocate call this once their result is on the
+    stack, so that every live object is reachable from the roots.
+*/
+#define GC_SAFEPOINT()                         \
+    do                                         \
+    {                                          \
+        if (heap.shouldCollect())              \
+            collectGarbage(bytecode);          \
+    } while (false)
 
 #ifdef TRACE_EXECUTION
-    printf("\n%s%s%5zu%s | ", ANSICodes::BOLD, ANSICodes::BLUE, ip, ANSICodes::RESET);
+#define TRACE_INSTRUCTION()                                                 \
+    do                                                                      \
+    {                                                                       \
+        printf("\n%s%s%5zu%s | ", ANSICodes::BOLD, ANSICodes::BLUE, ip, ANSICodes::RESET); \
+        for (const auto& stackItem : stack)                                 \
+            std::cout << stackItem.toString() << ", ";                      \
+        std::cout << std::endl;                                             \
+    } while (false)
+#else
+#define TRACE_INSTRUCTION() do {} while (false)
+#endif
 
-    for (const auto& stackItem : stack) {
-        std::cout << stackItem->toString() << ", ";
-    }
+// Binary operations on numbers with the right operand cached in tos
+#define CACHED_BINARY_OP(result)                                            \
+    do                                                                      \
+    {                                                                       \
+        if (!tos.isNumber() || !stack.top().isNumber())                     \
+        {                                                                   \
+            error(translationUnit, bytecode, ip, "Operand must be a number."); \
+            return 1;                                                       \
+        }                                                                   \
+                                                                            \
+        const auto left = stack.top().asNumber();                           \
+        const auto right = tos.asNumber();                                  \
+        stack.pop();                                                        \
+        tos = (result);                                                     \
+    } while (false)
+
+/*
+    With threaded dispatch, every handler is also a label, and ends by
+    jumping straight to the handler of the next instruction. The switch
+    is only used to dispatch the first one. Every program ends in RET,
+    so there is no need to check for the end of the code.
 
-    std::cout << std::endl;
+    Otherwise, handlers are plain cases, and end by breaking out of the
+    switch back into the loop.
+*/
+#ifdef THREADED_DISPATCH
+#define HANDLER(op) case op: op_##op
+#define NEXT()                                                              \
+    do                                                                      \
+    {                                                                       \
+        ip++;                                                               \
+        TRACE_INSTRUCTION();                                                \
+        goto *dispatchTable[code[ip]];                                      \
+    } while (false)
+#else
+#define HANDLER(op) case op
+#define NEXT() break
 #endif
 
+/*
+    With stack caching, the top of the stack may be held in tos instead,
+    a local that the compiler can keep in a register. Instructions that
+    load a value leave it in tos and continue through cachedTable, whose
+    handlers expect the top in tos. Thus, in a*b+c, every intermediate
+    result stays in tos. tos is only ever passed by copy, so that its
+    address is never taken.
+
+    Instructions without a cached handler push tos back onto the stack
+    first, and then jump straight to their usual handler. The stack holds
+    the same values in both states, only in different places, so jumps
+    may land in either state.
+
+    Otherwise, handlers just push their results.
+*/
+#ifdef STACK_CACHING
+#define NEXT_CACHED()                                                       \
+    do                                                                      \
+    {                                                                       \
+        ip++;                                                               \
+        TRACE_INSTRUCTION();                                                \
+        goto *cachedTable[code[ip]];                                        \
+    } while (false)
+#define FLUSH(op)                                                           \
+    flush_##op:                                                             \
+        stack.push(Value(tos));                                             \
+        goto op_##op
+#define PUSH_RESULT(value) (tos = (value))
+#define NEXT_RESULT() NEXT_CACHED()
+#else
+#define PUSH_RESULT(value) stack.push(value)
+#define NEXT_RESULT() NEXT()
+#endif
+
+        // Kept in locals, rather than members, so that they live in registers.
+        const byte* const code = bytecode.blob.data();
+        const size_t codeSize = bytecode.blob.size();
+        size_t ip;
+        bool wide = false;
+
+#ifdef THREADED_DISPATCH
+        // In the order of OpCode
+        static const void* const dispatchTable[] = {
+            &&op_LDC, &&op_POP, &&op_POPN, &&op_LDVAR, &&op_SETVAR, &&op_POPVAR,
+            &&op_NEWARR, &&op_CLONEARR, &&op_NEWOBJ, &&op_NEWMAP, &&op_NEWSET,
+            &&op_NEWTYPED, &&op_SETPROP, &&op_LDPROP, &&op_INVOKE,
+            &&op_JMP, &&op_JNT, &&op_JIT, &&op_LOOP, &&op_WIDE,
+            &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_EXP,
+            &&op_INCR, &&op_DECR, &&op_NEG,
+            &&op_GRT, &&op_LST, &&op_GRE, &&op_LSE, &&op_EQU, &&op_NEQ,
+            &&op_AND, &&op_OR, &&op_NOT,
+            &&op_INCVAR, &&op_DECVAR,
+            &&op_ADDR, &&op_SUBR, &&op_MULR, &&op_DIVR, &&op_MODR,
+            &&op_GRTR, &&op_LSTR, &&op_GRER, &&op_LSER, &&op_EQUR, &&op_NEQR,
+            &&op_PRINT, &&op_RET,
+        };
+
+        static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == OpCode::RET + 1,
+            "Every opcode needs an entry in the dispatch table");
+#endif
+
+#ifdef STACK_CACHING
+        // Also in the order of OpCode
+        static const void* const cachedTable[] = {
+            &&cached_LDC, &&cached_POP, &&flush_POPN, &&cached_LDVAR, &&cached_SETVAR, &&cached_POPVAR,
+            &&flush_NEWARR, &&flush_CLONEARR, &&flush_NEWOBJ, &&flush_NEWMAP, &&flush_NEWSET,
+            &&flush_NEWTYPED, &&flush_SETPROP, &&flush_LDPROP, &&flush_INVOKE,
+            &&cached_JMP, &&cached_JNT, &&cached_JIT, &&cached_LOOP, &&cached_WIDE,
+            &&cached_ADD, &&cached_SUB, &&cached_MUL, &&cached_DIV, &&cached_MOD, &&cached_EXP,
+            &&cached_INCR, &&cached_DECR, &&cached_NEG,
+            &&cached_GRT, &&cached_LST, &&cached_GRE, &&cached_LSE, &&cached_EQU, &&cached_NEQ,
+            &&flush_AND, &&flush_OR, &&cached_NOT,
+            &&flush_INCVAR, &&flush_DECVAR,
+            &&flush_ADDR, &&flush_SUBR, &&flush_MULR, &&flush_DIVR, &&flush_MODR,
+            &&flush_GRTR, &&flush_LSTR, &&flush_GRER, &&flush_LSER, &&flush_EQUR, &&flush_NEQR,
+            &&cached_PRINT, &&flush_RET,
+        };
+
+        static_assert(sizeof(cachedTable) == sizeof(dispatchTable),
+            "Every opcode needs an entry in the cached dispatch table");
+
+        Value tos;
+#endif
+
+        for (ip = 0; ip < codeSize; ip++) {
+            TRACE_INSTRUCTION();
+
             switch (code[ip]) {
-                case LDC: {
-                    stack.push(GET_CONST());
-                    break;
+                HANDLER(LDC): {
+                    PUSH_RESULT(GET_CONST());
+                    NEXT_RESULT();
                 }
 
-                case POP: {
+                HANDLER(POP): {
                     stack.pop();
-                    break;
+                    NEXT();
                 }
 
-                case POPN: {
+                HANDLER(POPN): {
                     auto popCount = READ_OPERAND();
                     stack.multipop(popCount);
-                    break;
+                    NEXT();
                 }
 
-                case LDVAR: {
+                HANDLER(LDVAR): {
                     auto stackIndex = READ_OPERAND();
-                    stack.push(stack[stackIndex]);
-                    break;
+                    PUSH_RESULT(stack[stackIndex]);
+                    NEXT_RESULT();
                 }
 
-                case SETVAR: {
+                HANDLER(SETVAR): {
                     auto stackIndex = READ_OPERAND();
                     stack[stackIndex] = stack.top();
-                    break;
+                    heap.writeBarrier(stack.top());
+                    NEXT();
+                }
+
+                HANDLER(POPVAR): {
+                    auto stackIndex = READ_OPERAND();
+                    stack[stackIndex] = stack.top();
+                    heap.writeBarrier(stack.top());
+                    stack.pop();
+                    NEXT();
                 }
 
-                case NEWARR: {
+                HANDLER(NEWARR): {
                     auto arraySize = READ_OPERAND();
 
-                    auto arrObj = std::make_shared<ArrayObject>();
+                    auto arrObj = heap.allocate<ArrayObject>();
                     for (size_t i = 0; i < arraySize; i++) {
-                        arrObj->push(stack[stack.size() - arraySize + i]);
+                        const auto& element = stack[stack.size() - arraySize + i];
+                        arrObj->push(element);
+                        heap.writeBarrier(arrObj, i, element);
                     }
 
                     stack.multipop(arraySize);
-                    stack.push(arrObj);
+                    stack.push(Value::object(arrObj));
+                    GC_SAFEPOINT();
 
-                    break;
+                    NEXT();
+                }
+
+                HANDLER(CLONEARR): {
+                    const auto source = GET_CONST();
+
+                    auto arrObj = heap.allocate<ArrayObject>(source.asArray());
+                    heap.writeBarrier(arrObj, source);
+
+                    stack.push(Value::object(arrObj));
+                    GC_SAFEPOINT();
+
+                    NEXT();
+                }
+
+                HANDLER(NEWOBJ): {
+                    auto propertyCount = READ_OPERAND();
+                    const auto base = stack.size() - propertyCount * 2;
+
+                    auto obj = heap.allocate<PlainObject>(heap.emptyShape());
+                    for (size_t i = 0; i < propertyCount; i++) {
+                        obj->set(stack[base + i * 2], stack[base + i * 2 + 1], heap);
+                    }
+
+                    stack.multipop(propertyCount * 2);
+                    stack.push(Value::object(obj));
+                    GC_SAFEPOINT();
+
+                    NEXT();
+                }
+
+                HANDLER(NEWMAP): {
+                    const auto argCount = READ_OPERAND();
+
+                    auto map = heap.allocate<MapObject>();
+                    std::string message;
+                    if (argCount == 1 && !fillMap(heap, *map, stack.top(), message)) {
+                        error(translationUnit, bytecode, ip, message);
+                        return 1;
+                    }
+
+                    stack.multipop(argCount);
+                    stack.push(Value::object(map));
+                    GC_SAFEPOINT();
+
+                    NEXT();
+                }
+
+                HANDLER(NEWSET): {
+                    const auto argCount = READ_OPERAND();
+
+                    auto set = heap.allocate<SetObject>();
+                    std::string message;
+                    if (argCount == 1 && !fillSet(heap, *set, stack.top(), message)) {
+                        error(translationUnit, bytecode, ip, message);
+                        return 1;
+                    }
+
+                    stack.multipop(argCount);
+                    stack.push(Value::object(set));
+                    GC_SAFEPOINT();
+
+                    NEXT();
+                }
+
+                HANDLER(NEWTYPED): {
+                    const auto elementType = static_cast<TypedArrayObject::ElementType>(READ_OPERAND());
+                    const auto argCount = READ_OPERAND();
+                    const auto source = argCount == 1 ? stack.top() : Value::number(0);
+
+                    Value typedArray;
+                    std::string message;
+                    if (!newTypedArray(heap, elementType, source, typedArray, message)) {
+                        error(translationUnit, bytecode, ip, message);
+                        return 1;
+                    }
+
+                    stack.multipop(argCount);
+                    stack.push(typedArray);
+                    GC_SAFEPOINT();
+
+                    NEXT();
                 }
 
-                case SETPROP: { 
+                HANDLER(SETPROP): { 
+                    auto& cache = bytecode.propertyCaches[READ_OPERAND()];
+
                     const auto newVal = stack.top();
                     stack.pop();
 
@@ -209,210 +518,619 @@ namespace cu {
 
                     const auto& object = stack.top();
 
-                    switch (object->type) {
+                    switch (object.type()) {
                         case ObjectType::ARRAY: {
-                            const auto arr = std::dynamic_pointer_cast<ArrayObject>(object).get();
-                            (*arr)[property] = newVal;
+                            const auto arr = object.asArray();
+                            if (!arr->setPacked(property, newVal)) {
+                                arr->set(property, newVal, heap);
+                            }
+
+                            break;
+                        }
+                        case ObjectType::TYPED_ARRAY: {
+                            const auto typed = object.asTypedArray();
+                            if (!typed->setIndexed(property, newVal)) {
+                                typed->set(property, newVal, heap);
+                            }
+
+                            break;
+                        }
+                        case ObjectType::OBJECT: {
+                            const auto obj = object.asPlainObject();
+                            const auto entry = cache.find(obj->getShape(), property);
+
+                            if (entry == nullptr) {
+                                const auto shape = obj->getShape();
+                                obj->set(property, newVal, heap);
+                                cacheStore(cache, shape, *obj, property);
+                            } else if (entry->transition != nullptr) {
+                                obj->addSlot(entry->transition, newVal, heap);
+                            } else {
+                                obj->setSlot(entry->slot, newVal, heap);
+                            }
+
                             break;
                         }
                         default:
                             break;
                     }
 
-                    break;
+                    NEXT();
                 }
 
-                case LDPROP: {
+                HANDLER(LDPROP): {
+                    auto& cache = bytecode.propertyCaches[READ_OPERAND()];
+
                     const auto property = stack.top();
                     stack.pop();
                     
                     const auto object = stack.top();
                     stack.pop();
 
-                    switch (object->type) {
+                    switch (object.type()) {
                         case ObjectType::ARRAY: {
-                            const auto& arr = *std::dynamic_pointer_cast<ArrayObject>(object).get();
-                            stack.push(arr[property]);
+                            const auto arr = object.asArray();
+                            Value element;
+                            if (!arr->getPacked(property, element)) {
+                                element = arr->get(property, heap);
+                            }
+
+                            stack.push(element);
                             break;
                         }
+                        case ObjectType::TYPED_ARRAY: {
+                            const auto typed = object.asTypedArray();
+                            Value element;
+                            if (!typed->getIndexed(property, element)) {
+                                element = typed->get(property, heap);
+                            }
+
+                            stack.push(element);
+                            break;
+                        }
+                        case ObjectType::OBJECT: {
+                            const auto obj = object.asPlainObject();
+                            const auto entry = cache.find(obj->getShape(), property);
+
+                            if (entry == nullptr) {
+                                stack.push(obj->get(property, heap));
+                                cacheLoad(cache, *obj, property);
+                            } else {
+                                stack.push(obj->getSlot(entry->slot));
+                            }
+
+                            break;
+                        }
+                        case ObjectType::STRING:
+                            stack.push(stringProperty(heap, object, property));
+                            GC_SAFEPOINT();
+                            break;
+                        case ObjectType::MAP:
+                        case ObjectType::SET:
+                            stack.push(collectionProperty(object, property));
+                            break;
                         default:
-                            stack.push(std::make_shared<EmptyObject>(ObjectType::UNDEFINED));
+                            stack.push(Value::undefined());
                     }
 
-                    break;
+                    NEXT();
                 }
 
-                case JMP: {
-                    // decrementing to offset for the loop increment
-                    auto jumpOffset = READ_OPERAND() - 1;
-                    ip = jumpOffset;
-                    break;
+                HANDLER(INVOKE): {
+                    const auto name = GET_CONST().asString();
+                    const size_t argCount = READ_OPERAND();
+                    const auto receiverIndex = stack.size() - argCount - 1;
+
+                    const auto method = findMethod(stack[receiverIndex], *name);
+                    if (method == nullptr) {
+                        error(translationUnit, bytecode, ip, "Undefined method: " + name->toString());
+                        return 1;
+                    }
+
+                    const NativeCall call{ heap, stack[receiverIndex], stack.data() + receiverIndex + 1, argCount };
+                    Value result;
+                    std::string message;
+
+                    if (!method(call, result, message)) {
+                        error(translationUnit, bytecode, ip, message);
+                        return 1;
+                    }
+
+                    stack.multipop(argCount + 1);
+                    stack.push(result);
+                    GC_SAFEPOINT();
+                    NEXT();
                 }
 
-                case JNT: {
-                    // decrementing to offset for the loop increment
-                    auto jumpOffset = READ_OPERAND() - 1;
-                    if (!isTruthy(stack.top())) {
-                        ip = jumpOffset;
+                /*
+                    Jump distances count from the next instruction. IP is
+                    at the last byte of the operand here, and NEXT()
+                    increments it once more.
+                */
+                HANDLER(JMP): {
+                    const size_t distance = READ_JUMP();
+                    ip += distance;
+                    NEXT();
+                }
+
+                HANDLER(JNT): {
+                    const size_t distance = READ_JUMP();
+                    if (!stack.top().isTruthy()) {
+                        ip += distance;
                     }
 
-                    break;
+                    NEXT();
+                }
+
+                HANDLER(JIT): {
+                    const size_t distance = READ_JUMP();
+                    const auto& top = stack.top();
+                    if (!top.isBoolean()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a boolean.");
+                        return 1;
+                    }
+
+                    if (top.asBoolean()) {
+                        ip += distance;
+                    }
+
+                    NEXT();
+                }
+
+                HANDLER(LOOP): {
+                    const size_t distance = READ_JUMP();
+                    ip -= distance;
+                    NEXT();
+                }
+
+                HANDLER(WIDE): {
+                    wide = true;
+                    NEXT();
                 }
                 
                 // Basic arithmetic
-                case NEG: {
-                    auto obj = stack.top();
-                    if (obj->type != ObjectType::NUMBER) {
-                        error(translationUnit, bytecode, "Operand must be a number.");
+                HANDLER(NEG): {
+                    auto& top = stack.top();
+                    if (!top.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
                         return 1;
                     }
 
-                    stack.pop();
-
-                    auto numObj = std::dynamic_pointer_cast<NumberObject>(obj);
-                    stack.push(std::make_shared<NumberObject>(-numObj->get()));
-                    break;
+                    top = Value::number(-top.asNumber());
+                    NEXT();
                 }
 
-                case ADD: {
+                HANDLER(ADD): {
                     auto rightVal = stack.top();
                     stack.pop();
                     auto leftVal = stack.top();
                     stack.pop();
 
-                    if (leftVal->type == ObjectType::STRING || rightVal->type == ObjectType::STRING) {
-                        auto concat = leftVal->toString() + rightVal->toString();
-                        stack.push(std::make_shared<StringObject>(concat));
-                    } else if (leftVal->type == ObjectType::NUMBER && rightVal->type == ObjectType::NUMBER) {
-                        auto left = std::dynamic_pointer_cast<NumberObject>(leftVal);
-                        auto right = std::dynamic_pointer_cast<NumberObject>(rightVal);
-                        stack.push(std::make_shared<NumberObject>(left->get() + right->get()));
+                    if (leftVal.isNumber() && rightVal.isNumber()) {
+                        stack.push(Value::number(leftVal.asNumber() + rightVal.asNumber()));
+                    } else if (leftVal.isString() || rightVal.isString()) {
+                        stack.push(concatenate(leftVal, rightVal));
+                        GC_SAFEPOINT();
                     } else {
-                        error(translationUnit, bytecode, "Invalid operand types for operator +");
+                        error(translationUnit, bytecode, ip, "Invalid operand types for operator +");
                         return 1;
                     }
 
-                    break;
+                    NEXT();
                 }
                 
-                case SUB: BINARY_OP(-, NumberObject); break;
-                case MUL: BINARY_OP(*, NumberObject); break;
-                case DIV: BINARY_OP(/, NumberObject); break;
-                case MOD: {
+                HANDLER(SUB): BINARY_OP(-, Value::number); NEXT();
+                HANDLER(MUL): BINARY_OP(*, Value::number); NEXT();
+                HANDLER(DIV): BINARY_OP(/, Value::number); NEXT();
+                HANDLER(MOD): {
                     auto rightVal = stack.top();
-                    if (rightVal->type != ObjectType::NUMBER)
+                    if (!rightVal.isNumber())
                     {
-                        error(translationUnit, bytecode, "Operand must be a number.");
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
                         return 1;
                     }
                     stack.pop();
 
                     auto leftVal = stack.top();
-                    if (leftVal->type != ObjectType::NUMBER)
+                    if (!leftVal.isNumber())
                     {
-                        error(translationUnit, bytecode, "Operand must be a number.");
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
                         return 1;
                     }
                     stack.pop();
 
-                    auto left = std::dynamic_pointer_cast<NumberObject>(leftVal);
-                    auto right = std::dynamic_pointer_cast<NumberObject>(rightVal);
-                    stack.push(std::make_shared<NumberObject>(std::fmod(left->get(), right->get())));
-                    break;
+                    stack.push(Value::number(std::fmod(leftVal.asNumber(), rightVal.asNumber())));
+                    NEXT();
                 };
-                case EXP: {
+                HANDLER(EXP): {
                     auto rightVal = stack.top();
-                    if (rightVal->type != ObjectType::NUMBER) {
-                        error(translationUnit, bytecode, "Operand must be a number.");
+                    if (!rightVal.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
                         return 1;
                     }
                     stack.pop();
 
                     auto leftVal = stack.top();
-                    if (leftVal->type != ObjectType::NUMBER) {
-                        error(translationUnit, bytecode, "Operand must be a number.");
+                    if (!leftVal.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
                         return 1;
                     }
                     stack.pop();
 
-                    auto left = std::dynamic_pointer_cast<NumberObject>(leftVal);
-                    auto right = std::dynamic_pointer_cast<NumberObject>(rightVal);
-                    stack.push(std::make_shared<NumberObject>(std::pow(left->get(), right->get())));  
-                    break;
+                    stack.push(Value::number(std::pow(leftVal.asNumber(), rightVal.asNumber())));
+                    NEXT();
                 }
 
-                case INCR: {
-                    if (stack.top()->type != ObjectType::NUMBER) {
-                        error(translationUnit, bytecode, "Cannot increment non-numeric type");
+                HANDLER(INCR): {
+                    auto& top = stack.top();
+                    if (!top.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Cannot increment non-numeric type");
                         return 1;
                     }
 
-                    std::dynamic_pointer_cast<NumberObject>(stack.top())->increment();
-                    break;
+                    top = Value::number(top.asNumber() + 1);
+                    NEXT();
                 }
 
-                case DECR: {
-                    if (stack.top()->type != ObjectType::NUMBER) {
-                        error(translationUnit, bytecode, "Cannot decrement non-numeric type");
+                HANDLER(DECR): {
+                    auto& top = stack.top();
+                    if (!top.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Cannot decrement non-numeric type");
                         return 1;
                     }
 
-                    std::dynamic_pointer_cast<NumberObject>(stack.top())->decrement();
-                    break;
+                    top = Value::number(top.asNumber() - 1);
+                    NEXT();
                 }
 
                 // Arithmetic comparison
-                case GRT: BINARY_OP(>, BooleanObject); break;
-                case LST: BINARY_OP(<, BooleanObject); break;
-                case GRE: BINARY_OP(>=, BooleanObject); break;
-                case LSE: BINARY_OP(<=, BooleanObject); break;
+                HANDLER(GRT): BINARY_OP(>, Value::boolean); NEXT();
+                HANDLER(LST): BINARY_OP(<, Value::boolean); NEXT();
+                HANDLER(GRE): BINARY_OP(>=, Value::boolean); NEXT();
+                HANDLER(LSE): BINARY_OP(<=, Value::boolean); NEXT();
 
                 // Equality comparison
-                case EQU: EQUALITY_OP(==); break;
-                case NEQ: EQUALITY_OP(!=); break;
+                HANDLER(EQU): {
+                    auto rightVal = stack.top();
+                    stack.pop();
+                    auto& leftVal = stack.top();
+                    leftVal = Value::boolean(leftVal.strictEquals(rightVal));
+                    NEXT();
+                }
+
+                HANDLER(NEQ): {
+                    auto rightVal = stack.top();
+                    stack.pop();
+                    auto& leftVal = stack.top();
+                    leftVal = Value::boolean(!leftVal.strictEquals(rightVal));
+                    NEXT();
+                }
 
                 // Logical
-                case AND: BINARY_LOGICAL_OP(&&); break;
-                case OR:  BINARY_LOGICAL_OP(||); break;
-                case NOT: {
-                    auto obj = stack.top();
-                    if (obj->type != ObjectType::BOOLEAN) {
-                        error(translationUnit, bytecode, "Operand must be a boolean.");
+                HANDLER(AND): BINARY_LOGICAL_OP(&&); NEXT();
+                HANDLER(OR):  BINARY_LOGICAL_OP(||); NEXT();
+                HANDLER(NOT): {
+                    auto& top = stack.top();
+                    if (!top.isBoolean()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a boolean.");
                         return 1;
                     }
 
-                    stack.pop();
-                    auto numObj = std::dynamic_pointer_cast<BooleanObject>(obj);
-                    stack.push(std::make_shared<BooleanObject>(!numObj->get()));
-                    break;
+                    top = Value::boolean(!top.asBoolean());
+                    NEXT();
                 }
 
-                case PRINT: {
+                HANDLER(INCVAR): {
+                    auto& variable = stack[READ_OPERAND()];
+                    if (!variable.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Cannot increment non-numeric type");
+                        return 1;
+                    }
+
+                    variable = Value::number(variable.asNumber() + 1);
+                    NEXT();
+                }
+
+                HANDLER(DECVAR): {
+                    auto& variable = stack[READ_OPERAND()];
+                    if (!variable.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Cannot decrement non-numeric type");
+                        return 1;
+                    }
+
+                    variable = Value::number(variable.asNumber() - 1);
+                    NEXT();
+                }
+
+                // Register operations
+                HANDLER(ADDR): {
+                    const auto leftVal = READ_REGISTER();
+                    const auto rightVal = READ_REGISTER();
+
+                    if (leftVal.isNumber() && rightVal.isNumber()) {
+                        PUSH_RESULT(Value::number(leftVal.asNumber() + rightVal.asNumber()));
+                        NEXT_RESULT();
+                    }
+
+                    if (leftVal.isString() || rightVal.isString()) {
+                        stack.push(concatenate(leftVal, rightVal));
+                        GC_SAFEPOINT();
+                        NEXT();
+                    }
+
+                    error(translationUnit, bytecode, ip, "Invalid operand types for operator +");
+                    return 1;
+                }
+
+                HANDLER(SUBR): REGISTER_OP(-, Value::number); NEXT_RESULT();
+                HANDLER(MULR): REGISTER_OP(*, Value::number); NEXT_RESULT();
+                HANDLER(DIVR): REGISTER_OP(/, Value::number); NEXT_RESULT();
+                HANDLER(MODR): {
+                    const auto leftVal = READ_REGISTER();
+                    const auto rightVal = READ_REGISTER();
+                    if (!leftVal.isNumber() || !rightVal.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
+                        return 1;
+                    }
+
+                    PUSH_RESULT(Value::number(std::fmod(leftVal.asNumber(), rightVal.asNumber())));
+                    NEXT_RESULT();
+                }
+
+                HANDLER(GRTR): REGISTER_OP(>, Value::boolean); NEXT_RESULT();
+                HANDLER(LSTR): REGISTER_OP(<, Value::boolean); NEXT_RESULT();
+                HANDLER(GRER): REGISTER_OP(>=, Value::boolean); NEXT_RESULT();
+                HANDLER(LSER): REGISTER_OP(<=, Value::boolean); NEXT_RESULT();
+
+                HANDLER(EQUR): {
+                    const auto leftVal = READ_REGISTER();
+                    const auto rightVal = READ_REGISTER();
+                    PUSH_RESULT(Value::boolean(leftVal.strictEquals(rightVal)));
+                    NEXT_RESULT();
+                }
+
+                HANDLER(NEQR): {
+                    const auto leftVal = READ_REGISTER();
+                    const auto rightVal = READ_REGISTER();
+                    PUSH_RESULT(Value::boolean(!leftVal.strictEquals(rightVal)));
+                    NEXT_RESULT();
+                }
+
+                HANDLER(PRINT): {
                     std::cout << ANSICodes::WHITE <<
-                        stack.top()->toString() << ANSICodes::RESET << std::endl;
+                        stack.top().toString() << ANSICodes::RESET << std::endl;
                     stack.pop();
+                    NEXT();
+                }
+
+                HANDLER(RET): {
+                    ip = codeSize;
                     break;
                 }
 
                 default:
-                    printf("%sVM Error: Invalid instruction (%li)\n%s", ANSICodes::RED, code[ip], ANSICodes::RESET);
+                    printf("%sVM Error: Invalid instruction (%d)\n%s", ANSICodes::RED, code[ip], ANSICodes::RESET);
+                    return 1;
+
+#ifdef STACK_CACHING
+                // Handlers for when the top of the stack is cached in tos
+
+                // Instructions without a cached handler
+                FLUSH(POPN);
+                FLUSH(NEWARR);
+                FLUSH(CLONEARR);
+                FLUSH(NEWOBJ);
+                FLUSH(NEWMAP);
+                FLUSH(NEWSET);
+                FLUSH(NEWTYPED);
+                FLUSH(SETPROP);
+                FLUSH(LDPROP);
+                FLUSH(INVOKE);
+                FLUSH(AND);
+                FLUSH(OR);
+                FLUSH(INCVAR);
+                FLUSH(DECVAR);
+                FLUSH(ADDR);
+                FLUSH(SUBR);
+                FLUSH(MULR);
+                FLUSH(DIVR);
+                FLUSH(MODR);
+                FLUSH(GRTR);
+                FLUSH(LSTR);
+                FLUSH(GRER);
+                FLUSH(LSER);
+                FLUSH(EQUR);
+                FLUSH(NEQR);
+                FLUSH(RET);
+
+                cached_LDC: {
+                    stack.push(Value(tos));
+                    tos = GET_CONST();
+                    NEXT_CACHED();
+                }
+
+                cached_POP: NEXT();
+
+                cached_LDVAR: {
+                    // The variable may be the one in tos
+                    stack.push(Value(tos));
+                    tos = stack[READ_OPERAND()];
+                    NEXT_CACHED();
+                }
+
+                cached_SETVAR: {
+                    // Setting the variable in tos to itself does nothing
+                    const size_t stackIndex = READ_OPERAND();
+                    if (stackIndex < stack.size()) {
+                        stack[stackIndex] = tos;
+                        heap.writeBarrier(Value(tos));
+                    }
+
+                    NEXT_CACHED();
+                }
+
+                cached_POPVAR: {
+                    stack[READ_OPERAND()] = tos;
+                    heap.writeBarrier(Value(tos));
+                    NEXT();
+                }
+
+                cached_JMP: {
+                    const size_t distance = READ_JUMP();
+                    ip += distance;
+                    NEXT_CACHED();
+                }
+
+                cached_JNT: {
+                    const size_t distance = READ_JUMP();
+                    if (!tos.isTruthy()) {
+                        ip += distance;
+                    }
+
+                    NEXT_CACHED();
+                }
+
+                cached_JIT: {
+                    const size_t distance = READ_JUMP();
+                    if (!tos.isBoolean()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a boolean.");
+                        return 1;
+                    }
+
+                    if (tos.asBoolean()) {
+                        ip += distance;
+                    }
+
+                    NEXT_CACHED();
+                }
+
+                cached_LOOP: {
+                    const size_t distance = READ_JUMP();
+                    ip -= distance;
+                    NEXT_CACHED();
+                }
+
+                cached_WIDE: {
+                    wide = true;
+                    NEXT_CACHED();
+                }
+
+                cached_ADD: {
+                    const auto leftVal = stack.top();
+                    if (leftVal.isNumber() && tos.isNumber()) {
+                        stack.pop();
+                        tos = Value::number(leftVal.asNumber() + tos.asNumber());
+                        NEXT_CACHED();
+                    }
+
+                    // Concatenation allocates, and the result must be on the stack
+                    // by the safepoint.
+                    if (leftVal.isString() || tos.isString()) {
+                        stack.top() = concatenate(leftVal, Value(tos));
+                        GC_SAFEPOINT();
+                        NEXT();
+                    }
+
+                    error(translationUnit, bytecode, ip, "Invalid operand types for operator +");
                     return 1;
+                }
+
+                cached_SUB: CACHED_BINARY_OP(Value::number(left - right)); NEXT_CACHED();
+                cached_MUL: CACHED_BINARY_OP(Value::number(left * right)); NEXT_CACHED();
+                cached_DIV: CACHED_BINARY_OP(Value::number(left / right)); NEXT_CACHED();
+                cached_MOD: CACHED_BINARY_OP(Value::number(std::fmod(left, right))); NEXT_CACHED();
+                cached_EXP: CACHED_BINARY_OP(Value::number(std::pow(left, right))); NEXT_CACHED();
+
+                cached_INCR: {
+                    if (!tos.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Cannot increment non-numeric type");
+                        return 1;
+                    }
+
+                    tos = Value::number(tos.asNumber() + 1);
+                    NEXT_CACHED();
+                }
+
+                cached_DECR: {
+                    if (!tos.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Cannot decrement non-numeric type");
+                        return 1;
+                    }
+
+                    tos = Value::number(tos.asNumber() - 1);
+                    NEXT_CACHED();
+                }
+
+                cached_NEG: {
+                    if (!tos.isNumber()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a number.");
+                        return 1;
+                    }
+
+                    tos = Value::number(-tos.asNumber());
+                    NEXT_CACHED();
+                }
+
+                cached_GRT: CACHED_BINARY_OP(Value::boolean(left > right)); NEXT_CACHED();
+                cached_LST: CACHED_BINARY_OP(Value::boolean(left < right)); NEXT_CACHED();
+                cached_GRE: CACHED_BINARY_OP(Value::boolean(left >= right)); NEXT_CACHED();
+                cached_LSE: CACHED_BINARY_OP(Value::boolean(left <= right)); NEXT_CACHED();
+
+                cached_EQU: {
+                    tos = Value::boolean(stack.top().strictEquals(Value(tos)));
+                    stack.pop();
+                    NEXT_CACHED();
+                }
+
+                cached_NEQ: {
+                    tos = Value::boolean(!stack.top().strictEquals(Value(tos)));
+                    stack.pop();
+                    NEXT_CACHED();
+                }
+
+                cached_NOT: {
+                    if (!tos.isBoolean()) {
+                        error(translationUnit, bytecode, ip, "Operand must be a boolean.");
+                        return 1;
+                    }
+
+                    tos = Value::boolean(!tos.asBoolean());
+                    NEXT_CACHED();
+                }
+
+                cached_PRINT: {
+                    std::cout << ANSICodes::WHITE <<
+                        Value(tos).toString() << ANSICodes::RESET << std::endl;
+                    NEXT();
+                }
+#endif
             }
         }
 #ifdef UNWIND_STACK
         // Print stack residue
         while (!stack.empty()) {
-            std::cout << ANSICodes::RED << stack.top()->toString() << ANSICodes::RESET << std::endl;
+            std::cout << ANSICodes::RED << stack.top().toString() << ANSICodes::RESET << std::endl;
             stack.pop();
         }
 #endif
 
 #undef BINARY_OP
 #undef BINARY_MATH_H
-#undef EQUALITY_OP
+#undef BINARY_LOGICAL_OP
+#undef READ_REGISTER
+#undef CACHED_BINARY_OP
+#undef NEXT_CACHED
+#undef FLUSH
+#undef PUSH_RESULT
+#undef NEXT_RESULT
+#undef REGISTER_OP
 #undef GET_CONST
-#undef GET_STRING
 #undef READ_OPERAND
+#undef READ_JUMP
+#undef TRACE_INSTRUCTION
+#undef HANDLER
+#undef NEXT
+#undef GC_SAFEPOINT
 
         return 0;
     }
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2020 Rohit Awate
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "Object.h"
+#include "ValueTable.h"
+
+namespace cu {
+
+	constexpr uint32_t ValueTable::EMPTY;
+	constexpr size_t ValueTable::INITIAL_CAPACITY;
+	constexpr size_t ValueTable::MAX_LOAD;
+	constexpr size_t ValueTable::NOT_FOUND;
+
+	// Spreads the bits of a word, so that keys that differ in
+	// only a few bits, such as small integers, do not cluster.
+	static uint64_t mix(uint64_t bits) {
+		bits ^= bits >> 33;
+		bits *= 0xff51afd7ed558ccdull;
+		bits ^= bits >> 33;
+		bits *= 0xc4ceb9fe1a85ec53ull;
+		bits ^= bits >> 33;
+		return bits;
+	}
+
+	uint64_t ValueTable::hashOf(const Value& key) {
+		if (key.isString()) return key.asString()->hashCode();
+
+		// 0 and -0 are the same key. NaNs are already canonical.
+		if (key.isNumber() && key.asNumber() == 0) return mix(Value::number(0).getBits());
+
+		return mix(key.getBits());
+	}
+
+	const Value* ValueTable::find(const Value& key) const {
+		const auto index = indexOf(key, hashOf(key));
+		return index != NOT_FOUND ? &entries[index].value : nullptr;
+	}
+
+	void ValueTable::set(const Value& key, const Value& value) {
+		const auto hash = hashOf(key);
+
+		const auto index = indexOf(key, hash);
+		if (index != NOT_FOUND) {
+			entries[index].value = value;
+			return;
+		}
+
+		if ((entries.size() + 1) * 100 > slots.size() * MAX_LOAD) {
+			size_t capacity = INITIAL_CAPACITY;
+			while ((count + 1) * 200 > capacity * MAX_LOAD) capacity *= 2;
+			rebuild(capacity);
+		}
+
+		entries.push_back({ key, value, false });
+		place(hash, entries.size() - 1);
+		count++;
+	}
+
+	bool ValueTable::remove(const Value& key) {
+		const auto index = indexOf(key, hashOf(key));
+		if (index == NOT_FOUND) return false;
+
+		// Let go of the key and value, but keep the entry
+		// so that probing continues past its slot.
+		entries[index] = { Value::undefined(), Value::undefined(), true };
+		count--;
+		return true;
+	}
+
+	void ValueTable::clear() {
+		entries.clear();
+		slots.clear();
+		count = 0;
+		layout++;
+	}
+
+	size_t ValueTable::footprint() const {
+		return entries.capacity() * sizeof(Entry) + slots.capacity() * sizeof(uint32_t);
+	}
+
+	void ValueTable::trace(Tracer& tracer) {
+		bool moved = false;
+
+		for (auto& entry : entries) {
+			if (entry.removed) continue;
+
+			const auto key = entry.key;
+			tracer.visit(entry.key);
+			tracer.visit(entry.value);
+
+			if (!entry.key.isIdentical(key) && !entry.key.isString()) moved = true;
+		}
+
+		if (moved) rebuild(slots.size());
+	}
+
+	bool ValueTable::traceSome(Tracer& tracer, TraceCursor& cursor, const size_t limit) {
+		// Entries that a rebuild moved below the cursor would be missed.
+		if (cursor.layout != layout) {
+			cursor.layout = layout;
+			cursor.index = 0;
+		}
+
+		const size_t end = std::min(entries.size(), cursor.index + limit);
+		for (; cursor.index < end; cursor.index++) {
+			auto& entry = entries[cursor.index];
+			if (entry.removed) continue;
+
+			tracer.visit(entry.key);
+			tracer.visit(entry.value);
+		}
+
+		return cursor.index == entries.size();
+	}
+
+	size_t ValueTable::indexOf(const Value& key, const uint64_t hash) const {
+		if (slots.empty()) return NOT_FOUND;
+
+		const size_t mask = slots.size() - 1;
+		for (size_t i = hash & mask; slots[i] != EMPTY; i = (i + 1) & mask) {
+			const auto& entry = entries[slots[i]];
+			if (!entry.removed && entry.key.sameValueZero(key)) return slots[i];
+		}
+
+		return NOT_FOUND;
+	}
+
+	void ValueTable::place(const uint64_t hash, const uint32_t index) {
+		const size_t mask = slots.size() - 1;
+
+		size_t i = hash & mask;
+		while (slots[i] != EMPTY) {
+			i = (i + 1) & mask;
+		}
+
+		slots[i] = index;
+	}
+
+	void ValueTable::rebuild(const size_t capacity) {
+		layout++;
+
+		if (count != entries.size()) {
+			std::vector<Entry> live;
+			live.reserve(count);
+
+			for (const auto& entry : entries) {
+				if (!entry.removed) live.push_back(entry);
+			}
+
+			entries.swap(live);
+		}
+
+		slots.assign(capacity, EMPTY);
+		for (uint32_t index = 0; index < entries.size(); index++) {
+			place(hashOf(entries[index].key), index);
+		}
+	}
+
+} // namespace cu
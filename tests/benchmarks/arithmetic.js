@@ -0,0 +1,9 @@
+// Integer and floating point arithmetic in a tight loop
+let sum = 0;
+let x = 1.5;
+for (let i = 0; i < 3000000; i = i + 1) {
+	sum = sum + i * 2 - i % 7;
+	x = x * 1.000001 + 0.5 / (i + 1);
+}
+print(sum);
+print(x > 0);
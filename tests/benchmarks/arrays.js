@@ -0,0 +1,14 @@
+// Array writes and reads by index
+let arr = [];
+for (let i = 0; i < 100000; i = i + 1) {
+	arr.push(i);
+}
+
+let total = 0;
+for (let round = 0; round < 10; round = round + 1) {
+	for (let i = 0; i < arr.length; i = i + 1) {
+		arr[i] = arr[i] + 1;
+		total = total + arr[i];
+	}
+}
+print(total);
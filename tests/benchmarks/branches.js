@@ -0,0 +1,19 @@
+// Comparisons and conditionals, with break and continue
+let evens = 0;
+let odds = 0;
+let i = 0;
+while (true) {
+	i++;
+	if (i > 2000000) break;
+	if (i % 3 == 0) continue;
+
+	if (i % 2 == 0) {
+		evens++;
+	} else if (i % 5 == 0 && i > 10) {
+		odds = odds + 2;
+	} else {
+		odds++;
+	}
+}
+print(evens);
+print(odds);
@@ -0,0 +1,14 @@
+// Map and Set insertion and lookup
+let map = new Map();
+let set = new Set();
+for (let i = 0; i < 200000; i = i + 1) {
+	map.set(i, i * 2);
+	set.add(i % 1000);
+}
+
+let hits = 0;
+for (let i = 0; i < 400000; i = i + 1) {
+	if (map.has(i)) hits++;
+}
+print(hits);
+print(set.size);
@@ -0,0 +1,13 @@
+// Iterative Fibonacci, repeated
+let result = 0;
+for (let n = 0; n < 60000; n = n + 1) {
+	let a = 0;
+	let b = 1;
+	for (let k = 0; k < 70; k = k + 1) {
+		let t = a + b;
+		a = b;
+		b = t;
+	}
+	result = a;
+}
+print(result);
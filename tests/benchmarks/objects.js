@@ -0,0 +1,8 @@
+// Named property loads and stores through inline caches
+let point = {x: 0, y: 0, z: 0};
+for (let i = 0; i < 1000000; i = i + 1) {
+	point.x = point.x + 1;
+	point.y = point.y + point.x;
+	point.z = point.y - point.x;
+}
+print(point.z);
@@ -0,0 +1,12 @@
+// String concatenation and indexing
+let s = "";
+for (let i = 0; i < 200000; i = i + 1) {
+	s = s + "ab";
+}
+
+let count = 0;
+for (let i = 0; i < s.length; i = i + 97) {
+	if (s[i] == "a") count++;
+}
+print(s.length);
+print(count);
@@ -0,0 +1,8 @@
+// Float64Array element access
+let data = new Float64Array(100000);
+for (let round = 0; round < 10; round = round + 1) {
+	for (let i = 0; i < data.length; i = i + 1) {
+		data[i] = data[i] + i * 0.5;
+	}
+}
+print(data.sum());
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+
+"""
+cubench
+The Copper Benchmark Harness
+
+Runs every benchmark in the benchmarks directory a few times and
+reports the fastest run of each. Given a second cu executable with
+--baseline, runs that one too and reports the speedup over it.
+"""
+
+from argparse import ArgumentParser
+from os import listdir
+from os.path import isfile, join, realpath, dirname, abspath
+import subprocess
+import sys
+import time
+
+
+HARNESS_DIR = dirname(realpath(__file__))
+BENCHMARKS_DIR = join(HARNESS_DIR, "benchmarks")
+CU_EXE_PATH = abspath(join(HARNESS_DIR, "..", "build/cu"))
+
+DEFAULT_RUNS = 5
+
+
+def run_benchmark(exe_path: str, filepath: str, runs: int) -> float:
+    """Returns the fastest of the runs in seconds, or None if any failed."""
+    best = None
+
+    for _ in range(runs):
+        start = time.perf_counter()
+        returncode = subprocess.call([exe_path, filepath], stdout=subprocess.DEVNULL)
+        elapsed = time.perf_counter() - start
+
+        if returncode != 0:
+            return None
+
+        best = elapsed if best is None else min(best, elapsed)
+
+    return best
+
+
+def format_time(secs) -> str:
+    return "failed" if secs is None else f"{secs * 1000:.1f} ms"
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description="Runs the Copper benchmark suite.")
+    parser.add_argument("--cu", default=CU_EXE_PATH, help="cu executable to benchmark")
+    parser.add_argument("--baseline", help="cu executable to compare against")
+    parser.add_argument("--runs", type=int, default=DEFAULT_RUNS, help="runs per benchmark")
+    args = parser.parse_args()
+
+    filenames = sorted(filename for filename in listdir(BENCHMARKS_DIR)
+                       if isfile(join(BENCHMARKS_DIR, filename)) and filename.endswith(".js"))
+
+    header = f"{'benchmark':<20}{'time':>12}"
+    if args.baseline: header += f"{'baseline':>12}{'speedup':>10}"
+    print(header)
+
+    failed = False
+    for filename in filenames:
+        filepath = join(BENCHMARKS_DIR, filename)
+
+        secs = run_benchmark(args.cu, filepath, args.runs)
+        failed = failed or secs is None
+        line = f"{filename:<20}{format_time(secs):>12}"
+
+        if args.baseline:
+            baseline_secs = run_benchmark(args.baseline, filepath, args.runs)
+            line += f"{format_time(baseline_secs):>12}"
+            if secs and baseline_secs:
+                line += f"{baseline_secs / secs:>9.2f}x"
+
+        print(line)
+
+    sys.exit(1 if failed else 0)
@@ -6,6 +6,8 @@ The Copper Test Harness
 
 Runs the entire JS suite of tests unless any of them is
 marked with a "cutest-ignore" comment at the very top of the file.
+A test that needs longer than the default timeout can name its own
+with a "cutest-timeout: <seconds>" comment there instead.
 """
 
 from os import listdir
@@ -15,6 +17,7 @@ from threading import Timer
 
 
 CUTEST_IGNORE_COMMENT = "// cutest-ignore"
+CUTEST_TIMEOUT_COMMENT = "// cutest-timeout:"
 
 HARNESS_DIR = dirname(realpath(__file__))
 JS_SUITE_DIR = join(HARNESS_DIR, "js_suite")
@@ -29,6 +32,16 @@ def is_ignore_test(filepath: str) -> bool:
     return contents.startswith(CUTEST_IGNORE_COMMENT)
 
 
+def get_timeout_secs(filepath: str) -> float:
+    with open(filepath) as fd:
+        first_line = fd.readline().strip()
+
+    if first_line.startswith(CUTEST_TIMEOUT_COMMENT):
+        return float(first_line[len(CUTEST_TIMEOUT_COMMENT):])
+
+    return TEST_TIMEOUT_SECS
+
+
 SUCCESS = 0
 FAILED = 1
 TIMEOUT = -1
@@ -42,7 +55,7 @@ def run_test(filepath: str) -> int:
 
     test_process = subprocess.Popen([CU_EXE_PATH, filepath])
 
-    timer = Timer(TEST_TIMEOUT_SECS, test_process.kill)
+    timer = Timer(get_timeout_secs(filepath=filepath), test_process.kill)
 
     try:
         timer.start()
@@ -1,8 +1,6 @@
-// cutest-ignore
-
 let homoList = ["apples", "oranges", "watermelons"]; 
 let heteroList = [1, 2, "hello", true];
-print(heteroList[1])
+print(heteroList[1]);
 print(heteroList[2]);
 
 // Array of objects
@@ -37,4 +35,65 @@ const matrix = [
 	[7, 8, 9]
 ];
 print(matrix[0][0]);
-print(matrix[2][2]);
\ No newline at end of file
+print(matrix[2][2]);
+
+// Sparse arrays
+let sparse = [];
+sparse[1000000000] = 1;
+sparse[3] = "three";
+print(sparse[1000000000]);
+print(sparse[3]);
+print(sparse[4]);
+print(sparse);
+
+// Numeric arrays
+let squares = [];
+let n = 0;
+while (n < 10) {
+	squares[n] = n * n;
+	n = n + 1;
+}
+print(squares[9]);
+squares[10] = "done";
+print(squares);
+
+// Named properties print in insertion order
+let named = [1];
+named["zeta"] = 1;
+named["alpha"] = 2;
+print(named);
+
+// Index keys
+let digits = [10, 20, 30];
+print(digits["1"]);
+digits["01"] = "not an index";
+print(digits[1]);
+print(digits["01"]);
+
+// Arrays from the same literal do not share writes
+for (let i = 0; i < 2; i++) {
+	let row = [1, 2, 3];
+	row[0] = row[0] + i;
+	print(row);
+}
+
+// Builtins
+let stack = [3, 1, 4];
+print(stack.push(1, 5));
+print(stack.pop());
+print(stack.length);
+print(stack.indexOf(1));
+print(stack.indexOf(1, 2));
+print(stack.includes(4));
+print(stack.slice(1, -1));
+print(stack.sum());
+print(stack.min());
+print(stack.max());
+stack.fill(0, 2);
+print(stack);
+
+// Numbers are found in arrays that also hold other values
+let mixed = ["one", 2, 0 / 0];
+print(mixed.indexOf(2));
+print(mixed.indexOf(0 / 0));
+print(mixed.includes(0 / 0));
@@ -0,0 +1,36 @@
+// Map
+let map = new Map([["a", 1], ["b", 2]]);
+map.set(3, "three").set(true, null);
+print(map);
+print(map.size);
+print(map.get("a"));
+print(map.get("3"));
+print(map.has(true));
+
+// 0 and -0 are the same key, and so is NaN
+map.set(0, "zero");
+print(map.get(-0));
+map.set(0 / 0, "nan");
+print(map.get(0 / 0));
+
+print(map.delete("a"));
+print(map.delete("a"));
+print(map.keys());
+print(map.entries());
+
+// Objects are keys by identity
+let key = [1];
+map.set(key, "array");
+print(map.get(key));
+print(map.get([1]));
+
+// Set
+let set = new Set([1, 2, 2, "x", "x"]);
+print(set);
+print(set.size);
+print(set.has("x"));
+set.delete(2);
+set.add(2);
+print(set.values());
+set.clear();
+print(set.size);
@@ -0,0 +1,31 @@
+// Singletons
+let t = true == true;
+let f = true == false;
+let n = null == null;
+let u = undefined == undefined;
+
+print(t);
+print(f);
+print(n);
+print(u);
+
+// Numbers compare by value, NaN is never equal
+print(0 == -0);
+print((0 / 0) == (0 / 0));
+
+// Strings compare by contents, arrays by identity
+const arr = [1, 2];
+print("copper" == "copper");
+print(arr == arr);
+print(arr == [1, 2]);
+
+// Falsy values
+if (0 / 0) {
+	print("NaN is truthy");
+} else if ("") {
+	print("empty string is truthy");
+} else if (null) {
+	print("null is truthy");
+} else {
+	print("all falsy");
+}
@@ -0,0 +1,75 @@
+const config = {
+	port: 8080,
+	https: true,
+	domain: 'www.example.com',
+};
+
+let fruitColors = {
+	"apple": "red",
+	"orange": "orange",
+	"watermelon": "green"
+};
+
+// Nested objects
+let people = {
+	"Rohit": {
+		from: "India",
+		github: "RohitAwate",
+		age: 22
+	},
+	'Bruce': {
+		'from': "Gotham",
+		"github": "Batman",
+		age: 40
+	},
+	Clark: {
+		'from': "Metropolis",
+		"github": "Superman",
+		age: 40
+	},
+};
+
+let objects = {
+	key1: {},
+	"key2": {},
+	'key3': {}
+};
+
+print(config.port);
+print(fruitColors["apple"]);
+print(people.Rohit.github);
+print(people['Clark']["age"]);
+
+// Setting properties
+config.port = 443;
+people.Bruce.age = 41;
+objects.key1.nested = true;
+print(config);
+print(people.Bruce);
+print(objects.key1);
+
+// The same access on objects of different shapes
+let points = [{x: 1, y: 2}, {y: 3, x: 4}, {x: 5}];
+let sum = 0;
+for (let i = 0; i < 3; i++) {
+	sum = sum + points[i].x;
+}
+print(sum);
+
+// More shapes than one site caches
+let shapes = [{a: 1}, {b: 1, a: 2}, {c: 1, a: 3}, {d: 1, a: 4}, {e: 1, a: 5}, {f: 1, a: 6}];
+let total = 0;
+for (let i = 0; i < 6; i++) {
+	total = total + shapes[i].a;
+}
+print(total);
+
+// Keys computed at runtime
+let counts = {};
+for (let i = 0; i < 3; i++) {
+	counts["key" + i] = i;
+}
+counts.key1 = 10;
+print(counts);
+print(counts["key" + 1]);
+print(counts.key2);
@@ -1 +1,24 @@
-const msg = "hello, world!\n";
\ No newline at end of file
+const msg = "hello, world!\n";
+// Building a string piece by piece
+let csv = "";
+for (let i = 0; i < 1000; i++) {
+	csv = csv + i + ",";
+}
+
+const greeting = `${msg}from copper`;
+print(greeting == "hello, world!\nfrom copper");
+
+// Strings outside of ASCII
+const latin = "café";
+const wide = "€uro";
+print(latin + " " + wide);
+print(wide == "€" + "uro");
+
+// Slicing
+const record = "2020-06-01 12:00:00 INFO copper started";
+const level = record.slice(20, 24);
+const text = record.slice(record.indexOf("copper"));
+print(level);
+print(text);
+print(record.length);
+print(record[0]);
@@ -0,0 +1,35 @@
+// Zero-filled
+let doubles = new Float64Array(4);
+doubles[0] = 1.5;
+doubles[3] = -0.25;
+print(doubles);
+print(doubles.length);
+
+// Out-of-bounds reads are undefined, and writes are ignored
+print(doubles[4]);
+doubles[4] = 1;
+print(doubles.length);
+
+// Stores wrap around to the element type
+let ints = new Int32Array([1, 2.7, -3.9, 4294967301, 2147483648, true, null]);
+print(ints);
+let bytes = new Uint8Array([255, 256, -1]);
+bytes["1"] = 300;
+print(bytes);
+
+// Copying between element types
+let sum = 0;
+let copy = new Float64Array(ints);
+for (let i = 0; i < copy.length; i = i + 1) {
+	sum = sum + copy[i];
+}
+print(sum);
+
+// Builtins
+let samples = new Float64Array([2.5, -1, 4, 0 / 0]);
+print(samples.includes(0 / 0));
+print(samples.indexOf(4));
+samples.fill(1, 3);
+print(samples.sum());
+print(samples.min());
+print(samples.max());
@@ -38,3 +38,27 @@ let lbc = bc;
 lfc = lic;
 lsc = lssc;
 lbc = lfc;
+
+// INCREMENT & DECREMENT
+let counter = 10;
+let before = counter++;
+let after = ++counter;
+counter--;
+--counter;
+
+// OPERATORS ON VARIABLES
+let sum = lic + lfc;
+let difference = counter - 1;
+let isSmaller = counter < lic;
+let isSame = counter == before;
+
+// CONDITIONS ON VARIABLES
+let tries = 0;
+while (true) {
+	tries++;
+	if (!(tries < 3)) break;
+}
+
+let raining = false;
+if (!raining) tries = 0;
+if (false) tries = 1;